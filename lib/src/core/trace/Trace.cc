@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <atomic>
+#include <core/trace/Trace.hh>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <nitrate-core/Logger.hh>
+#include <string>
+#include <unistd.h>
+
+using namespace ncc;
+using namespace no3::trace;
+
+namespace {
+  class TraceSink final {
+    std::mutex m_mutex;
+    std::FILE* m_file = nullptr;
+    bool m_first_event = true;
+    std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+  public:
+    TraceSink() {
+      const auto* path = std::getenv("NCC_TRACE_FILE");
+      if (path == nullptr || *path == '\0') {
+        return;
+      }
+
+      m_file = std::fopen(path, "w");
+      if (m_file == nullptr) {
+        Log << "Failed to open trace file: " << path;
+        return;
+      }
+
+      std::fputs("[\n", m_file);
+    }
+
+    TraceSink(const TraceSink&) = delete;
+    TraceSink(TraceSink&&) = delete;
+
+    /// Terminate the JSON array. Spans still closing on other threads are dropped.
+    void Close() {
+      std::lock_guard lock(m_mutex);
+      if (m_file != nullptr) {
+        std::fputs("\n]\n", m_file);
+        std::fclose(m_file);
+        m_file = nullptr;
+      }
+    }
+
+    [[nodiscard]] auto IsOpen() const -> bool { return m_file != nullptr; }
+
+    void Write(std::string_view category, std::string_view name, std::chrono::steady_clock::time_point start,
+               std::chrono::steady_clock::time_point end);
+  };
+
+  auto GetThreadID() -> uint64_t {
+    static std::atomic<uint64_t> next_id = 1;
+    thread_local const auto id = next_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+  }
+
+  void AppendEscaped(std::string& out, std::string_view str) {
+    for (char ch : str) {
+      if (ch == '"' || ch == '\\') {
+        out += '\\';
+        out += ch;
+      } else if (static_cast<unsigned char>(ch) < 0x20) {
+        out += ' ';
+      } else {
+        out += ch;
+      }
+    }
+  }
+
+  auto GetSink() -> TraceSink& {
+    // Leaked on purpose: worker threads may still close spans during static destruction
+    static auto* sink = [] {
+      auto* sink = new TraceSink();
+      if (sink->IsOpen()) {
+        std::atexit([] { GetSink().Close(); });
+      }
+
+      return sink;
+    }();
+
+    return *sink;
+  }
+}  // namespace
+
+void TraceSink::Write(std::string_view category, std::string_view name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+  using Microseconds = std::chrono::duration<double, std::micro>;
+
+  std::string event;
+  event.reserve(128 + name.size());
+  event += R"({"ph":"X","cat":")";
+  AppendEscaped(event, category);
+  event += R"(","name":")";
+  AppendEscaped(event, name);
+  event += R"(","pid":)";
+  event += std::to_string(::getpid());
+  event += R"(,"tid":)";
+  event += std::to_string(GetThreadID());
+  event += R"(,"ts":)";
+  event += std::to_string(Microseconds(start - m_epoch).count());
+  event += R"(,"dur":)";
+  event += std::to_string(Microseconds(end - start).count());
+  event += '}';
+
+  std::lock_guard lock(m_mutex);
+  if (m_file == nullptr) [[unlikely]] {
+    return;
+  }
+
+  if (!m_first_event) {
+    std::fputs(",\n", m_file);
+  }
+
+  m_first_event = false;
+  std::fwrite(event.data(), 1, event.size(), m_file);
+}
+
+auto no3::trace::IsEnabled() -> bool {
+  static const bool enabled = GetSink().IsOpen();
+  return enabled;
+}
+
+Span::Span(std::string_view category, std::string_view name)
+    : m_category(category), m_name(name), m_active(IsEnabled()) {
+  if (m_active) {
+    m_start = std::chrono::steady_clock::now();
+  }
+}
+
+Span::~Span() {
+  if (m_active) {
+    GetSink().Write(m_category, m_name, m_start, std::chrono::steady_clock::now());
+  }
+}
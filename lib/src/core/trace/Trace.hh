@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Scoped spans exported in the Chrome trace-event format (loadable by
+ * chrome://tracing and Perfetto).
+ *
+ * Spans are only recorded when the process was started with `NCC_TRACE_FILE`
+ * set to a writable path; otherwise each span costs one relaxed load. Building
+ * without `NO3_TRACING` removes them entirely.
+ */
+namespace no3::trace {
+  /// Whether `NCC_TRACE_FILE` was set and opened; decided once per process.
+  [[nodiscard]] auto IsEnabled() -> bool;
+
+  class Span final {
+    std::string_view m_category;
+    std::string_view m_name;
+    std::chrono::steady_clock::time_point m_start;
+    bool m_active;
+
+  public:
+    /// Both views must outlive the span.
+    Span(std::string_view category, std::string_view name);
+    Span(const Span&) = delete;
+    Span(Span&&) = delete;
+    ~Span();
+  };
+}  // namespace no3::trace
+
+#define NO3_TRACE_CONCAT_IMPL(a, b) a##b
+#define NO3_TRACE_CONCAT(a, b) NO3_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef NO3_TRACING
+#define NO3_TRACE_SPAN(category, name) \
+  const ::no3::trace::Span NO3_TRACE_CONCAT(no3_trace_span_, __LINE__)(category, name)
+#else
+#define NO3_TRACE_SPAN(category, name) static_cast<void>(0)
+#endif
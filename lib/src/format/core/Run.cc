@@ -37,6 +37,7 @@
 #include <boost/program_options/parsers.hpp>
 #include <core/cli/Interpreter.hh>
 #include <core/package/Manifest.hh>
+#include <core/trace/Trace.hh>
 #include <filesystem>
 #include <format/tree/Visitor.hh>
 #include <fstream>
@@ -129,6 +130,8 @@ static auto FormatFile(const std::filesystem::path& src, const std::filesystem::
   std::optional<FlowPtr<ncc::parse::Expr>> ptree_root;
 
   { /* Perform source code parsing */
+    NO3_TRACE_SPAN("format", "FormatFile::Parse");
+
     auto reenable_log = std::shared_ptr<void>(nullptr, [](auto) { Log->Enable(); });
     if (quiet_parser) {
       Log->Disable();
@@ -196,6 +199,9 @@ static auto FormatFile(const std::filesystem::path& src, const std::filesystem::
 
   bool okay = false;
 
+  // Covers emission and replacing the source file
+  NO3_TRACE_SPAN("format", "FormatFile::Emit");
+
   switch (mode) {
     case FormatMode::Standard: {
       bool has_errors = false;
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/program_options.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <impl/Benchmark.hh>
+#include <impl/Subcommands.hh>
+#include <nitrate-core/CatchAll.hh>
+#include <nitrate-core/Logger.hh>
+
+using namespace ncc;
+using namespace no3::benchmark;
+
+static const std::unordered_map<std::string_view, BenchmarkFunction> BENCHMARKS = {
+    {"lsp-stdio", BenchLspStdio},
+    {"lsp-transport", BenchLspTransport},
+    {"lsp-threadpool", BenchLspThreadPool},
+    {"lsp-edits", BenchLspDocumentEdits},
+    {"lsp-text-kernels", BenchLspTextKernels},
+};
+
+auto no3::benchmark::CreateJsonRpcBody(size_t size) -> std::string {
+  constexpr std::string_view kPrefix = R"({"jsonrpc":"2.0","method":"$/bench","params":")";
+  constexpr std::string_view kSuffix = R"("})";
+
+  std::string body;
+  body.reserve(std::max(size, kPrefix.size() + kSuffix.size()));
+  body += kPrefix;
+  body.append(size > kPrefix.size() + kSuffix.size() ? size - kPrefix.size() - kSuffix.size() : 0, 'x');
+  body += kSuffix;
+
+  return body;
+}
+
+auto no3::cmd_impl::subcommands::CommandImplBench(ConstArguments, const MutArguments& argv) -> bool {
+  namespace po = boost::program_options;
+
+  po::options_description desc("Allowed options");
+  po::positional_options_description p;
+  p.add("benchmark", 1);
+
+  BenchmarkOptions defaults;
+
+  auto add_option = desc.add_options();
+  add_option("help,h", "Display this help message");
+  add_option("list,l", "List the available benchmarks");
+  add_option("messages,n", po::value<size_t>()->default_value(defaults.m_messages), "Number of messages to send");
+  add_option("size,s", po::value<size_t>()->default_value(defaults.m_message_size), "Message payload size in bytes");
+  add_option("buffer-size,b", po::value<size_t>()->default_value(defaults.m_buffer_size), "Stream buffer size in bytes");
+  add_option("verify", "Check results against a reference implementation instead of measuring, where supported");
+  add_option("benchmark", po::value<std::string>(), "Name of the benchmark to run");
+
+  std::vector<const char*> args;
+  args.reserve(argv.size());
+  for (const auto& arg : argv) {
+    args.push_back(arg.c_str());
+  }
+
+  po::variables_map vm;
+  if (auto cli_parser = OMNI_CATCH(po::command_line_parser(args.size(), args.data()).options(desc).positional(p).run());
+      !cli_parser || !OMNI_CATCH(po::store(*cli_parser, vm)) || !OMNI_CATCH(po::notify(vm))) {
+    Log << Error << "Failed to parse command line arguments.";
+    desc.print(*(Log << Raw));
+    return false;
+  };
+
+  Log << Trace << "Parsed command line arguments.";
+
+  if (vm.contains("help")) {
+    desc.print(*(Log << Raw));
+    return true;
+  }
+
+  if (vm.contains("list")) {
+    for (const auto& [name, _] : BENCHMARKS) {
+      Log << Raw << name << "\n";
+    }
+
+    return true;
+  }
+
+  if (!vm.contains("benchmark")) {
+    Log << "benchmark: 1 argument(s) expected. 0 provided.";
+    desc.print(*(Log << Raw));
+    return false;
+  }
+
+  const auto name = vm.at("benchmark").as<std::string>();
+  const auto it = BENCHMARKS.find(name);
+  if (it == BENCHMARKS.end()) {
+    Log << "Unknown benchmark: \"" << name << "\". Use --list to see the available benchmarks.";
+    return false;
+  }
+
+  BenchmarkOptions options;
+  options.m_messages = vm.at("messages").as<size_t>();
+  options.m_message_size = vm.at("size").as<size_t>();
+  options.m_buffer_size = vm.at("buffer-size").as<size_t>();
+  options.m_verify = vm.contains("verify");
+
+  if (options.m_messages == 0 || options.m_buffer_size == 0) {
+    Log << "The message count and buffer size must be greater than zero.";
+    return false;
+  }
+
+  Log << Trace << "Running benchmark: " << name;
+
+  return it->second(options);
+}
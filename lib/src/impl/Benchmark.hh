@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace no3::benchmark {
+  struct BenchmarkOptions {
+    size_t m_messages = 10000;
+    size_t m_message_size = 1024;
+    size_t m_buffer_size = 64 * 1024;
+
+    /// Check results against a simple reference implementation instead of measuring, where supported.
+    bool m_verify = false;
+  };
+
+  using BenchmarkFunction = auto (*)(const BenchmarkOptions& options) -> bool;
+
+  /// Build a JSON-RPC notification body of (at least) `size` bytes.
+  auto CreateJsonRpcBody(size_t size) -> std::string;
+
+  auto BenchLspStdio(const BenchmarkOptions& options) -> bool;
+  auto BenchLspTransport(const BenchmarkOptions& options) -> bool;
+  auto BenchLspThreadPool(const BenchmarkOptions& options) -> bool;
+  auto BenchLspDocumentEdits(const BenchmarkOptions& options) -> bool;
+  auto BenchLspTextKernels(const BenchmarkOptions& options) -> bool;
+}  // namespace no3::benchmark
@@ -44,6 +44,7 @@ static const auto IMPL_SUBCOMMANDS = []() {
   m["config-check"] = cmd_impl::subcommands::CommandImplConfigParse;
   m["self-test"] = cmd_impl::subcommands::CommandImplSelfTest;
   m["parse"] = cmd_impl::subcommands::CommandImplParse;
+  m["bench"] = cmd_impl::subcommands::CommandImplBench;
 
   return m;
 }();
@@ -64,6 +65,9 @@ auto no3::cmd_impl::subcommands::CommandImplHelp(ConstArguments, const MutArgume
 ├───────────────┼──────────────────────────────────────────────────────────────┤
 │ parse         │ Parse a source file into a parse tree                        │
 │               │ Get help: https://nitrate.dev/docs/no3/impl/parse            │
+├───────────────┼──────────────────────────────────────────────────────────────┤
+│ bench         │ Run internal performance benchmarks                          │
+│               │ Get help: https://nitrate.dev/docs/no3/impl/bench            │
 ╰───────────────┴──────────────────────────────────────────────────────────────╯)";
 
   Log << Raw << message << "\n";
@@ -0,0 +1,250 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <impl/Benchmark.hh>
+#include <lsp/resource/FileBrowser.hh>
+#include <lsp/resource/Rope.hh>
+#include <nitrate-core/Logger.hh>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace ncc;
+using namespace no3::lsp;
+using namespace no3::lsp::core;
+
+/// Each measurement stops after this long, so the copying baseline stays usable on large files.
+static constexpr auto kTimeBudget = std::chrono::seconds(1);
+static constexpr size_t kLineLength = 80;
+static constexpr std::array kDocumentSizes = {
+    size_t(16) * 1024,
+    size_t(256) * 1024,
+    size_t(1) * 1024 * 1024,
+    size_t(5) * 1024 * 1024,
+    size_t(20) * 1024 * 1024,
+};
+
+static auto CreateDocument(size_t size) -> Rope::Bytes {
+  Rope::Bytes document;
+  document.reserve(size);
+
+  while (document.size() < size) {
+    for (size_t i = 0; i + 1 < kLineLength && document.size() < size; ++i) {
+      document.push_back('a' + (i % 26));
+    }
+
+    document.push_back('\n');
+  }
+
+  return document;
+}
+
+template <typename Edit>
+static auto MeasureEditsPerSecond(size_t max_edits, Edit edit) -> std::pair<size_t, double> {
+  const auto start = std::chrono::steady_clock::now();
+  size_t edits = 0;
+
+  while (edits < max_edits && std::chrono::steady_clock::now() - start < kTimeBudget) {
+    edit(edits++);
+  }
+
+  const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return {edits, edits / seconds};
+}
+
+static void BenchDocumentSize(size_t size, size_t max_edits) {
+  const auto document = CreateDocument(size);
+  const auto lines = document.size() / kLineLength;
+  const auto insertion = Rope::Bytes(1, 'x');
+
+  std::mt19937_64 rng(size);
+  const auto random_offset = [&](size_t limit) { return std::uniform_int_distribution<size_t>(0, limit)(rng); };
+
+  {  // What every keystroke used to cost: copy, splice and intern the whole buffer
+    auto flat = FlyByteString(document);
+    const auto [edits, rate] = MeasureEditsPerSecond(max_edits, [&](size_t) {
+      Rope::Bytes state = flat;
+      state.replace(random_offset(state.size()), 0, insertion);
+      flat = FlyByteString(std::move(state));
+    });
+
+    Log << Raw << "  flat copy:    " << rate << " edits/s (" << edits << " edits)\n";
+  }
+
+  {
+    auto rope = Rope(document);
+    const auto [edits, rate] = MeasureEditsPerSecond(
+        max_edits, [&](size_t) { rope = rope.Replace(random_offset(rope.Size()), 0, insertion); });
+
+    Log << Raw << "  rope replace: " << rate << " edits/s (" << edits << " edits, height " << rope.GetHeight()
+            << ")\n";
+  }
+
+  {  // The full incremental didChange path, including position conversion
+    FileBrowser browser(protocol::TextDocumentSyncKind::Incremental);
+    const auto uri = FlyString("file:///bench.nit");
+    (void)browser.DidOpen(uri, 0, FlyByteString(document));
+
+    const auto [edits, rate] = MeasureEditsPerSecond(max_edits, [&](size_t i) {
+      const auto position = protocol::Position(random_offset(lines - 1), random_offset(kLineLength - 1));
+      const std::array changes = {protocol::TextDocumentContentChangeEvent(
+          protocol::Range(position, position), insertion)};
+
+      (void)browser.DidChanges(uri, static_cast<FileVersion>(i + 1), changes);
+    });
+
+    Log << Raw << "  didChange:    " << rate << " edits/s (" << edits << " edits)\n";
+  }
+}
+
+/// Line starts of a flat buffer, treating CRLF, CR and LF each as one break.
+static auto GetReferenceLineStarts(const Rope::Bytes& text) -> std::vector<size_t> {
+  std::vector<size_t> starts = {0};
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+      ++i;
+    }
+
+    if (text[i] == '\r' || text[i] == '\n') {
+      starts.push_back(i + 1);
+    }
+  }
+
+  return starts;
+}
+
+/// Entry `offset` counts the line breaks wholly inside `text[0, offset)`; a CRLF split by `offset` counts as its CR.
+static auto GetReferenceLineBreakCounts(const Rope::Bytes& text) -> std::vector<size_t> {
+  std::vector<size_t> counts(text.size() + 1, 0);
+  for (size_t i = 0; i < text.size(); ++i) {
+    const bool is_break = text[i] == '\r' || (text[i] == '\n' && (i == 0 || text[i - 1] != '\r'));
+    counts[i + 1] = counts[i] + (is_break ? 1 : 0);
+  }
+
+  return counts;
+}
+
+/// Applies the same random edits to a rope and a flat string and compares them after every few.
+static auto VerifyRope(size_t edits) -> bool {
+  // Few distinct bytes, so CRLF pairs are formed and split across leaf boundaries often
+  static constexpr std::array<uint8_t, 4> kAlphabet = {'a', 'b', '\r', '\n'};
+  static constexpr size_t kCheckInterval = 50;
+
+  std::mt19937_64 rng(edits);
+  const auto random_below = [&](size_t limit) { return std::uniform_int_distribution<size_t>(0, limit - 1)(rng); };
+  const auto random_text = [&](size_t length) {
+    Rope::Bytes text(length, 0);
+    for (auto& byte : text) {
+      byte = kAlphabet[random_below(kAlphabet.size())];
+    }
+
+    return text;
+  };
+
+  auto flat = random_text(size_t(64) * 1024);
+  auto rope = Rope(flat);
+
+  for (size_t i = 0; i < edits; ++i) {
+    const auto offset = random_below(flat.size() + 1);
+    const auto count = random_below(std::min<size_t>(flat.size() - offset, 16) + 1);
+    const auto text = random_text(random_below(i % kCheckInterval == 0 ? 512 : 24));
+
+    flat.replace(offset, count, text);
+    rope = rope.Replace(offset, count, text);
+
+    if (i % kCheckInterval != 0 && i + 1 != edits) {
+      continue;
+    }
+
+    if (rope.Size() != flat.size() || rope.ToBytes() != flat) {
+      Log << "Rope contents diverged after edit " << i << " (replace " << count << " bytes at " << offset << ")";
+      return false;
+    }
+
+    const auto starts = GetReferenceLineStarts(flat);
+    const auto break_counts = GetReferenceLineBreakCounts(flat);
+    if (rope.GetLineCount() != starts.size()) {
+      Log << "Rope line count diverged after edit " << i << ": " << rope.GetLineCount() << " instead of "
+          << starts.size();
+      return false;
+    }
+
+    for (size_t line = 0; line <= starts.size(); ++line) {
+      const auto expected = line < starts.size() ? std::optional(starts[line]) : std::nullopt;
+      if (rope.GetLineStart(line) != expected) {
+        Log << "Rope start of line " << line << " diverged after edit " << i;
+        return false;
+      }
+    }
+
+    for (size_t probe = 0; probe < 256; ++probe) {
+      const auto at = random_below(flat.size() + 1);
+      if (rope.CountLineBreaks(at) != break_counts[at]) {
+        Log << "Rope line breaks before offset " << at << " diverged after edit " << i << ": "
+            << rope.CountLineBreaks(at) << " instead of " << break_counts[at];
+        return false;
+      }
+
+      const auto length = random_below(std::min<size_t>(flat.size() - at, 4096) + 1);
+      if (rope.Substr(at, length) != flat.substr(at, length)) {
+        Log << "Rope substring [" << at << ", " << at + length << ") diverged after edit " << i;
+        return false;
+      }
+    }
+  }
+
+  Log << Raw << "rope matches the flat reference over " << edits << " random edits (" << flat.size() << " bytes, "
+      << rope.GetLineCount() << " lines)\n";
+
+  return true;
+}
+
+auto no3::benchmark::BenchLspDocumentEdits(const BenchmarkOptions& options) -> bool {
+  FlyString::init();
+  FlyByteString::init();
+
+  if (options.m_verify) {
+    return VerifyRope(options.m_messages);
+  }
+
+  for (const auto size : kDocumentSizes) {
+    Log << Raw << "document of " << size / 1024 << " KiB, single-byte inserts at random positions:\n";
+    BenchDocumentSize(size, options.m_messages);
+  }
+
+  return true;
+}
@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <impl/Benchmark.hh>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <lsp/server/FrameDecoder.hh>
+#include <nitrate-core/Logger.hh>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+static constexpr std::string_view kContentType = "Content-Type: application/vscode-jsonrpc; charset=utf-8\r\n\r\n";
+
+/// A reader that gives up early closes the pipe under the writer; that must fail the write, not kill the run.
+class ScopedIgnoreSigpipe {
+  struct sigaction m_previous = {};
+
+public:
+  ScopedIgnoreSigpipe() {
+    struct sigaction ignore = {};
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &m_previous);
+  }
+
+  ScopedIgnoreSigpipe(const ScopedIgnoreSigpipe&) = delete;
+  ScopedIgnoreSigpipe& operator=(const ScopedIgnoreSigpipe&) = delete;
+  ~ScopedIgnoreSigpipe() { sigaction(SIGPIPE, &m_previous, nullptr); }
+};
+
+static void ReportThroughput(std::string_view direction, size_t messages, uint64_t bytes, uint64_t syscalls,
+                             std::chrono::nanoseconds elapsed) {
+  const auto seconds = std::chrono::duration<double>(elapsed).count();
+  const auto megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+
+  Log << Raw << direction << ": " << messages << " messages, " << megabytes << " MiB in " << seconds * 1000.0
+      << " ms, " << (seconds > 0 ? megabytes / seconds : 0.0) << " MiB/s, "
+      << static_cast<double>(syscalls) / static_cast<double>(messages) << " syscalls/message\n";
+}
+
+static auto BenchInbound(const no3::benchmark::BenchmarkOptions& options) -> bool {
+  std::array<int, 2> fds;
+  if (pipe(fds.data()) == -1) {
+    Log << "Failed to create pipe";
+    return false;
+  }
+
+  const auto body = no3::benchmark::CreateJsonRpcBody(options.m_message_size);
+
+  std::string frame = "Content-Length: " + std::to_string(body.size()) + "\r\n";
+  frame += kContentType;
+  frame += body;
+
+  std::jthread client([&frame, &options, out = fds[1]]() {
+    for (size_t i = 0; i < options.m_messages; ++i) {
+      size_t offset = 0;
+      while (offset < frame.size()) {
+        auto n = ::write(out, frame.data() + offset, frame.size() - offset);
+        if (n <= 0) {
+          close(out);
+          return;
+        }
+        offset += n;
+      }
+    }
+
+    close(out);
+  });
+
+  auto stream = FileDescriptorStream(std::make_unique<FileDescriptorStreamBuf>(fds[0], -1, true, options.m_buffer_size));
+  auto decoder = FrameDecoder(stream);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < options.m_messages; ++i) {
+    auto frame = decoder.Next();
+    if (!frame.has_value() || frame->m_content.size() != body.size()) {
+      Log << "Inbound benchmark: failed to read message #" << i;
+      return false;
+    }
+  }
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  const auto& stats = stream.GetStreamBuf().GetStatistics();
+
+  ReportThroughput("inbound ", options.m_messages, stats.m_bytes_read, stats.m_read_syscalls, elapsed);
+
+  return true;
+}
+
+static auto BenchOutbound(const no3::benchmark::BenchmarkOptions& options) -> bool {
+  std::array<int, 2> fds;
+  if (pipe(fds.data()) == -1) {
+    Log << "Failed to create pipe";
+    return false;
+  }
+
+  const auto body = no3::benchmark::CreateJsonRpcBody(options.m_message_size);
+
+  std::jthread client([in = fds[0]]() {
+    std::vector<char> sink(1024 * 1024);
+    while (::read(in, sink.data(), sink.size()) > 0) {
+    }
+
+    close(in);
+  });
+
+  uint64_t bytes_written = 0;
+  uint64_t write_syscalls = 0;
+  std::chrono::nanoseconds elapsed;
+
+  {
+    auto stream =
+        FileDescriptorStream(std::make_unique<FileDescriptorStreamBuf>(-1, fds[1], true, options.m_buffer_size));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Mirror the framing performed by Context::SendMessage()
+    for (size_t i = 0; i < options.m_messages; ++i) {
+      stream << "Content-Length: " << body.size() << "\r\n";
+      stream << kContentType;
+      stream << body;
+      stream.flush();
+    }
+
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto& stats = stream.GetStreamBuf().GetStatistics();
+    bytes_written = stats.m_bytes_written;
+    write_syscalls = stats.m_write_syscalls;
+  }
+
+  ReportThroughput("outbound", options.m_messages, bytes_written, write_syscalls, elapsed);
+
+  return true;
+}
+
+auto no3::benchmark::BenchLspStdio(const BenchmarkOptions& options) -> bool {
+  Log << Raw << "LSP stdio transport: " << options.m_message_size << " byte messages, " << options.m_buffer_size
+      << " byte stream buffers\n";
+
+  ScopedIgnoreSigpipe ignore_sigpipe;
+
+  return BenchInbound(options) && BenchOutbound(options);
+}
@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <array>
+#include <chrono>
+#include <impl/Benchmark.hh>
+#include <lsp/resource/TextKernels.hh>
+#include <nitrate-core/Logger.hh>
+#include <random>
+#include <vector>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+static constexpr auto kTimeBudget = std::chrono::milliseconds(500);
+static constexpr size_t kDocumentSize = size_t(4) * 1024 * 1024;
+static constexpr std::array kISAs = {text::ISA::Scalar, text::ISA::SSE2, text::ISA::AVX2};
+
+/// Source-like text: mostly ASCII, some multi-byte code points, CRLF line endings with a few bare LFs.
+static auto CreateDocument(size_t size) -> text::Bytes {
+  static constexpr std::array<std::string_view, 6> kPieces = {
+      "let x = 42; ", "fn main() { ", "/* caf\xC3\xA9 */ ", "\"\xE2\x82\xAC\" ", "// \xF0\x9F\x98\x80 ", "} ",
+  };
+
+  text::Bytes document;
+  document.reserve(size + 128);
+
+  std::mt19937 rng(size);
+  while (document.size() < size) {
+    for (size_t i = 0; i < 6; ++i) {
+      const auto piece = kPieces[rng() % kPieces.size()];
+      document.append(reinterpret_cast<const uint8_t*>(piece.data()), piece.size());
+    }
+
+    document += rng() % 8 == 0 ? text::BytesView(reinterpret_cast<const uint8_t*>("\n"), 1)
+                               : text::BytesView(reinterpret_cast<const uint8_t*>("\r\n"), 2);
+  }
+
+  return document;
+}
+
+/// Runs `kernel` over the whole document until the time budget is spent; returns GB/s.
+template <typename Kernel>
+static auto MeasureThroughput(size_t bytes_per_pass, Kernel kernel) -> double {
+  const auto start = std::chrono::steady_clock::now();
+  size_t passes = 0;
+  size_t sink = 0;
+
+  while (passes == 0 || std::chrono::steady_clock::now() - start < kTimeBudget) {
+    sink += kernel();
+    ++passes;
+  }
+
+  const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  asm volatile("" : : "r"(sink));
+
+  return static_cast<double>(passes * bytes_per_pass) / seconds / 1e9;
+}
+
+/// Short inputs cover the scalar tails, long ones the SIMD main loops and their counter flushes.
+static auto CreateVerifyInput(std::mt19937_64& rng, size_t index) -> text::Bytes {
+  static constexpr std::array<std::string_view, 8> kPieces = {
+      "a", "b", "\r", "\n", "\r\n", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80",
+  };
+
+  const auto size = index % 64 == 0 ? 16 * 1024 + rng() % 256 : rng() % 256;
+  const bool is_valid_utf8 = index % 2 == 0;
+
+  text::Bytes input;
+  while (input.size() < size) {
+    if (is_valid_utf8) {
+      const auto piece = kPieces[rng() % kPieces.size()];
+      input.append(reinterpret_cast<const uint8_t*>(piece.data()), piece.size());
+    } else {  // Stray continuation bytes, truncated sequences and bytes that never occur in UTF-8
+      input.push_back(static_cast<uint8_t>(rng()));
+    }
+  }
+
+  return input;
+}
+
+/// Everything the dispatched kernels return for `input`, under the current ISA.
+static auto RunKernels(text::BytesView input) -> std::vector<size_t> {
+  std::vector<size_t> results;
+
+  for (size_t start = 0; start <= input.size(); start += 1 + start / 4) {
+    results.push_back(text::FindLineBreak(input.substr(start)));
+  }
+
+  results.push_back(text::CountLineBreaks(input));
+
+  const auto units = text::CountUTF16Units(input);
+  results.push_back(units);
+
+  for (size_t column = 0; column <= units + 2; column += 1 + column / 8) {
+    results.push_back(text::FindUTF16Column(input, column));
+  }
+
+  return results;
+}
+
+/// Compares every supported ISA against the scalar kernels on random inputs.
+static auto VerifyKernels(size_t inputs, text::ISA detected) -> bool {
+  std::mt19937_64 rng(inputs);
+  std::array<size_t, kISAs.size()> checked{};
+
+  for (size_t i = 0; i < inputs; ++i) {
+    const auto input = CreateVerifyInput(rng, i);
+
+    (void)text::SetISA(text::ISA::Scalar);
+    const auto expected = RunKernels(input);
+
+    for (size_t k = 1; k < kISAs.size(); ++k) {
+      if (!text::SetISA(kISAs[k])) {
+        continue;
+      }
+
+      if (RunKernels(input) != expected) {
+        Log << text::GetISAName(kISAs[k]) << " kernels disagree with scalar on input " << i << " ("
+            << input.size() << " bytes)";
+        (void)text::SetISA(detected);
+        return false;
+      }
+
+      ++checked[k];
+    }
+  }
+
+  (void)text::SetISA(detected);
+
+  for (size_t k = 1; k < kISAs.size(); ++k) {
+    if (checked[k] == 0) {
+      Log << Raw << "  " << text::GetISAName(kISAs[k]) << ": not supported on this CPU\n";
+    } else {
+      Log << Raw << "  " << text::GetISAName(kISAs[k]) << ": matches scalar on " << checked[k] << " inputs\n";
+    }
+  }
+
+  return true;
+}
+
+auto no3::benchmark::BenchLspTextKernels(const BenchmarkOptions& options) -> bool {
+  if (options.m_verify) {
+    return VerifyKernels(options.m_messages, text::GetISA());
+  }
+
+  const auto document = CreateDocument(kDocumentSize);
+  const auto view = text::BytesView(document);
+  const auto detected = text::GetISA();
+
+  Log << Raw << "text kernels over " << document.size() / 1024 << " KiB, dispatching to "
+      << text::GetISAName(detected) << " by default:\n";
+
+  {  // Not dispatched: libc's memchr is vectorised already
+    text::Bytes normalized;
+    const auto normalize_to_lf = MeasureThroughput(view.size(), [&] {
+      normalized.clear();
+      text::NormalizeToLF(view, normalized);
+      return normalized.size();
+    });
+
+    Log << Raw << "  NormalizeToLF: " << normalize_to_lf << " GB/s\n";
+  }
+
+  for (const auto isa : kISAs) {
+    if (!text::SetISA(isa)) {
+      Log << Raw << "  " << text::GetISAName(isa) << ": not supported on this CPU\n";
+      continue;
+    }
+
+    const auto find_line_breaks = MeasureThroughput(view.size(), [&] {
+      size_t lines = 0;
+      for (size_t i = text::FindLineBreak(view); i < view.size(); i += 1 + text::FindLineBreak(view.substr(i + 1))) {
+        ++lines;
+      }
+
+      return lines;
+    });
+
+    const auto count_line_breaks = MeasureThroughput(view.size(), [&] { return text::CountLineBreaks(view); });
+    const auto count_utf16_units = MeasureThroughput(view.size(), [&] { return text::CountUTF16Units(view); });
+
+    // A column past the end walks the whole buffer, as clipping to a long line would
+    const auto find_utf16_column =
+        MeasureThroughput(view.size(), [&] { return text::FindUTF16Column(view, view.size() * 2); });
+
+    Log << Raw << "  " << text::GetISAName(isa) << ":\n";
+    Log << Raw << "    FindLineBreak (per line): " << find_line_breaks << " GB/s\n";
+    Log << Raw << "    CountLineBreaks:          " << count_line_breaks << " GB/s\n";
+    Log << Raw << "    CountUTF16Units:          " << count_utf16_units << " GB/s\n";
+    Log << Raw << "    FindUTF16Column:          " << find_utf16_column << " GB/s\n";
+  }
+
+  (void)text::SetISA(detected);
+
+  return true;
+}
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <impl/Benchmark.hh>
+#include <lsp/server/ThreadPool.hh>
+#include <memory>
+#include <nitrate-core/Logger.hh>
+#include <thread>
+#include <vector>
+
+using namespace ncc;
+
+/// Samples taken with the workers parked are each preceded by a sleep, so keep them few.
+static constexpr size_t kMaxParkedSamples = 1000;
+static constexpr auto kParkDelay = std::chrono::milliseconds(1);
+static constexpr auto kIdleWindow = std::chrono::seconds(1);
+
+static auto GetProcessCpuTime() -> std::chrono::microseconds {
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+
+  const auto to_us = [](const timeval& tv) {
+    return std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+  };
+
+  return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+static void MeasureIdleCpu(ThreadPool& pool) {
+  // Let the workers finish spinning first
+  pool.Schedule([](const std::stop_token&) {});
+  pool.WaitForAll();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  const auto cpu_start = GetProcessCpuTime();
+  std::this_thread::sleep_for(kIdleWindow);
+  const auto cpu_used = GetProcessCpuTime() - cpu_start;
+
+  const auto percent = 100.0 * std::chrono::duration<double>(cpu_used).count() /
+                       std::chrono::duration<double>(kIdleWindow).count();
+
+  Log << Raw << "idle: " << percent << "% of one core over " << kIdleWindow.count() << " s\n";
+}
+
+/// Shared with the sampled tasks, which may still be inside `notify_one()` when the next sample begins.
+struct LatencyProbe {
+  std::atomic<size_t> m_started = 0;
+  std::chrono::steady_clock::time_point m_start_time;  // published by `m_started`
+};
+
+static void MeasureLatency(ThreadPool& pool, std::string_view name, size_t samples, std::chrono::nanoseconds delay) {
+  std::vector<double> latencies_us;
+  latencies_us.reserve(samples);
+
+  const auto probe = std::make_shared<LatencyProbe>();
+
+  for (size_t i = 0; i < samples; ++i) {
+    if (delay.count() != 0) {
+      std::this_thread::sleep_for(delay);
+    }
+
+    const auto enqueue_time = std::chrono::steady_clock::now();
+    pool.Schedule([probe, sample = i + 1](const std::stop_token&) {
+      probe->m_start_time = std::chrono::steady_clock::now();
+      probe->m_started.store(sample, std::memory_order_release);
+      probe->m_started.notify_one();
+    });
+
+    for (auto started = probe->m_started.load(std::memory_order_acquire); started != i + 1;
+         started = probe->m_started.load(std::memory_order_acquire)) {
+      probe->m_started.wait(started, std::memory_order_acquire);
+    }
+
+    latencies_us.push_back(std::chrono::duration<double, std::micro>(probe->m_start_time - enqueue_time).count());
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  const auto percentile = [&](double p) { return latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))]; };
+
+  Log << Raw << name << ": enqueue-to-start p50 " << percentile(0.50) << " us, p99 " << percentile(0.99)
+      << " us, max " << latencies_us.back() << " us (" << samples << " samples)\n";
+}
+
+static void MeasureThroughput(ThreadPool& pool, size_t tasks) {
+  std::atomic<size_t> completed = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < tasks; ++i) {
+    pool.Schedule([&](const std::stop_token&) { completed.fetch_add(1, std::memory_order_relaxed); });
+  }
+
+  pool.WaitForAll();
+  while (completed.load(std::memory_order_relaxed) != tasks) {
+    std::this_thread::yield();
+  }
+
+  const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  Log << Raw << "burst: " << tasks << " empty tasks in " << seconds * 1000.0 << " ms, " << tasks / seconds
+      << " tasks/s\n";
+}
+
+auto no3::benchmark::BenchLspThreadPool(const BenchmarkOptions& options) -> bool {
+  ThreadPool pool;
+  pool.Start();
+
+  Log << Raw << "LSP thread pool with " << std::max(std::jthread::hardware_concurrency(), 1U) << " workers\n";
+
+  MeasureIdleCpu(pool);
+  MeasureLatency(pool, "hot", options.m_messages, std::chrono::nanoseconds(0));
+  MeasureLatency(pool, "parked", std::min(options.m_messages, kMaxParkedSamples), kParkDelay);
+  MeasureThroughput(pool, options.m_messages);
+
+  return true;
+}
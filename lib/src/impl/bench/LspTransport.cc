@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <impl/Benchmark.hh>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <lsp/server/FrameDecoder.hh>
+#include <nitrate-core/Logger.hh>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+static constexpr size_t kMaxLatencySamples = 2000;
+
+namespace {
+  struct Transport {
+    int m_client_in = -1;
+    int m_client_out = -1;
+    int m_server_in = -1;
+    int m_server_out = -1;
+  };
+}  // namespace
+
+static auto CreatePipeTransport() -> std::optional<Transport> {
+  std::array<int, 2> to_server;
+  std::array<int, 2> to_client;
+
+  if (pipe(to_server.data()) == -1) {
+    return std::nullopt;
+  }
+
+  if (pipe(to_client.data()) == -1) {
+    close(to_server[0]);
+    close(to_server[1]);
+    return std::nullopt;
+  }
+
+  return Transport{
+      .m_client_in = to_client[0],
+      .m_client_out = to_server[1],
+      .m_server_in = to_server[0],
+      .m_server_out = to_client[1],
+  };
+}
+
+static auto CreateUnixTransport() -> std::optional<Transport> {
+  std::array<int, 2> fds;
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()) == -1) {
+    return std::nullopt;
+  }
+
+  return Transport{
+      .m_client_in = fds[0],
+      .m_client_out = fds[0],
+      .m_server_in = fds[1],
+      .m_server_out = fds[1],
+  };
+}
+
+static auto CreateTcpTransport() -> std::optional<Transport> {
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd == -1) {
+    return std::nullopt;
+  }
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t addr_size = sizeof(addr);
+
+  if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 || listen(listen_fd, 1) == -1 ||
+      getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_size) == -1) {
+    close(listen_fd);
+    return std::nullopt;
+  }
+
+  int client_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (client_fd == -1 || connect(client_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    close(listen_fd);
+    if (client_fd != -1) {
+      close(client_fd);
+    }
+    return std::nullopt;
+  }
+
+  int server_fd = accept(listen_fd, nullptr, nullptr);
+  close(listen_fd);
+
+  if (server_fd == -1) {
+    close(client_fd);
+    return std::nullopt;
+  }
+
+  int opt = 1;
+  setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+  setsockopt(server_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+  return Transport{
+      .m_client_in = client_fd,
+      .m_client_out = client_fd,
+      .m_server_in = server_fd,
+      .m_server_out = server_fd,
+  };
+}
+
+static void EchoServer(int in, int out) {
+  auto stream = FileDescriptorStream(std::make_unique<FileDescriptorStreamBuf>(in, out, false));
+  auto decoder = FrameDecoder(stream);
+
+  while (auto frame = decoder.Next()) {
+    stream << "Content-Length: " << frame->m_content.size() << "\r\n\r\n";
+    stream.write(frame->m_content.data(), static_cast<std::streamsize>(frame->m_content.size()));
+    stream.flush();
+  }
+}
+
+static auto WriteAll(int fd, std::string_view data) -> bool {
+  while (!data.empty()) {
+    auto n = ::write(fd, data.data(), data.size());
+    if (n <= 0) {
+      return false;
+    }
+    data.remove_prefix(n);
+  }
+
+  return true;
+}
+
+static auto RunReplay(std::string_view name, const Transport& transport,
+                      const no3::benchmark::BenchmarkOptions& options) -> bool {
+  const auto body = no3::benchmark::CreateJsonRpcBody(options.m_message_size);
+  const auto frame = "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+  std::jthread server([&transport]() { EchoServer(transport.m_server_in, transport.m_server_out); });
+
+  auto client_stream =
+      FileDescriptorStream(std::make_unique<FileDescriptorStreamBuf>(transport.m_client_in, -1, false));
+  auto client_decoder = FrameDecoder(client_stream);
+
+  bool okay = true;
+  std::vector<double> latencies_us;
+
+  {  // Round-trip latency: one message in flight at a time
+    const auto samples = std::min(options.m_messages, kMaxLatencySamples);
+    latencies_us.reserve(samples);
+
+    for (size_t i = 0; i < samples && okay; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      okay = WriteAll(transport.m_client_out, frame) && client_decoder.Next().has_value();
+      latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+  }
+
+  std::chrono::nanoseconds elapsed{};
+
+  if (okay) {  // Throughput: pipeline the whole replay
+    const auto start = std::chrono::steady_clock::now();
+
+    std::jthread client_writer([&]() {
+      for (size_t i = 0; i < options.m_messages; ++i) {
+        if (!WriteAll(transport.m_client_out, frame)) {
+          return;
+        }
+      }
+    });
+
+    for (size_t i = 0; i < options.m_messages && okay; ++i) {
+      okay = client_decoder.Next().has_value();
+    }
+
+    client_writer.join();
+    elapsed = std::chrono::steady_clock::now() - start;
+  }
+
+  // Socket transports use one descriptor for both directions; close each exactly once
+  std::set<int> open_fds = {transport.m_client_in, transport.m_client_out, transport.m_server_in,
+                            transport.m_server_out};
+
+  // Signal EOF to the echo server. A pipe can not be half-closed, so its write end is closed early instead.
+  if (shutdown(transport.m_client_out, SHUT_WR) == -1) {
+    close(transport.m_client_out);
+    open_fds.erase(transport.m_client_out);
+  }
+
+  server.join();
+
+  for (int fd : open_fds) {
+    close(fd);
+  }
+
+  if (!okay) {
+    Log << "Transport benchmark failed for: " << name;
+    return false;
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  const auto percentile = [&](double p) { return latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))]; };
+
+  const auto seconds = std::chrono::duration<double>(elapsed).count();
+  const auto megabytes = static_cast<double>(frame.size() * options.m_messages) / (1024.0 * 1024.0);
+
+  Log << Raw << name << ": " << options.m_messages / seconds << " msg/s, " << megabytes / seconds
+      << " MiB/s each way, round-trip p50 " << percentile(0.50) << " us, p99 " << percentile(0.99) << " us\n";
+
+  return true;
+}
+
+auto no3::benchmark::BenchLspTransport(const BenchmarkOptions& options) -> bool {
+  Log << Raw << "LSP transport replay: " << options.m_messages << " x " << options.m_message_size
+      << " byte messages echoed by the server\n";
+
+  const std::array<std::pair<std::string_view, std::optional<Transport> (*)()>, 3> transports = {{
+      {"stdio (pipes)", CreatePipeTransport},
+      {"tcp (loopback)", CreateTcpTransport},
+      {"unix socket", CreateUnixTransport},
+  }};
+
+  for (const auto& [name, create] : transports) {
+    auto transport = create();
+    if (!transport.has_value()) {
+      Log << "Failed to create transport: " << name;
+      return false;
+    }
+
+    if (!RunReplay(name, *transport, options)) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -31,10 +31,13 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <pthread.h>
+
 #include <core/cli/GetOpt.hh>
 #include <core/cli/Interpreter.hh>
-#include <fstream>
+#include <csignal>
 #include <lsp/connect/Connection.hh>
+#include <lsp/server/AsyncFileLogger.hh>
 #include <lsp/server/Server.hh>
 #include <memory>
 #include <nitrate-core/Assert.hh>
@@ -60,6 +63,7 @@ class LspCommandArgumentParser {
   bool m_help = false;
   size_t m_stdio = 0;
   size_t m_port = 0;
+  size_t m_pipe = 0;
   std::string m_connect_arg;
   ConnectionType m_connection_mode = ConnectionType::Stdio;
   std::filesystem::path m_log_file;
@@ -67,12 +71,13 @@ class LspCommandArgumentParser {
 
   void DisplayHelp() {
     std::string_view help =
-        R"(Usage: lsp [--help] [[--port VAR]|[--stdio]] [--log VAR]
+        R"(Usage: lsp [--help] [[--port VAR]|[--pipe VAR]|[--stdio]] [--log VAR]
 
 Optional arguments:
   -h, --help          shows this help message and exits
   -s, --stdio         instruct LSP server to connect via stdin/stdout
-  -p, --port          instruct LSP server to listen on a TCP port
+  -p, --port          instruct LSP server to serve clients on a TCP port until interrupted
+  -u, --pipe          instruct LSP server to connect to a Unix domain socket
   -o, --log           log output file [default: "nitrate-lsp.log"]
 )";
 
@@ -80,11 +85,12 @@ Optional arguments:
   }
 
   void DoParse(std::vector<std::string> args) {
-    constexpr const char* kShortOptions = "hsp:o:";
+    constexpr const char* kShortOptions = "hsp:u:o:";
     constexpr std::array kLongOptions = {
         option{"help", no_argument, nullptr, 'h'},
         option{"stdio", no_argument, nullptr, 's'},
         option{"port", required_argument, nullptr, 'p'},
+        option{"pipe", required_argument, nullptr, 'u'},
         option{"log", required_argument, nullptr, 'o'},
         option{nullptr, 0, nullptr, 0},
     };
@@ -135,6 +141,19 @@ Optional arguments:
             break;
           }
 
+          case 'u': {
+            Log << Trace << "Parsing command line argument: --pipe, -u";
+
+            m_connection_mode = ConnectionType::Pipe;
+            m_connect_arg = optarg;
+            if (m_pipe++ > 0) {
+              Log << "The -u, --pipe argument was provided more than once.";
+              m_too_many_args = true;
+            }
+
+            break;
+          }
+
           case 'o': {
             Log << Trace << "Parsing command line argument: --log, -o";
             if (!m_log_file.empty()) {
@@ -180,8 +199,8 @@ Optional arguments:
     if (m_too_many_args) {
       Log << "Too many arguments provided.";
       okay = false;
-    } else if (m_stdio + m_port > 1) {
-      Log << "Only one of --stdio or --port can be specified.";
+    } else if (m_stdio + m_port + m_pipe > 1) {
+      Log << "Only one of --stdio, --port, or --pipe can be specified.";
       okay = false;
     }
 
@@ -208,36 +227,62 @@ public:
   [[nodiscard]] auto GetOptions() -> Options { return {m_log_file, m_connect_arg, m_connection_mode}; }
 };
 
+/// Blocks SIGINT and SIGTERM in the calling thread and, by inheritance, in every thread it spawns.
+class ScopedShutdownSignalBlock {
+  sigset_t m_old_signals = {};
+
+public:
+  ScopedShutdownSignalBlock() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &m_old_signals);
+  }
+
+  ScopedShutdownSignalBlock(const ScopedShutdownSignalBlock&) = delete;
+  ScopedShutdownSignalBlock& operator=(const ScopedShutdownSignalBlock&) = delete;
+  ~ScopedShutdownSignalBlock() { pthread_sigmask(SIG_SETMASK, &m_old_signals, nullptr); }
+};
+
 static bool StartServer(const std::filesystem::path& log_file, const ConnectionType& connection_mode,
                         const std::string& connection_arg) {
-  Log << Trace << "Opening connection for the LSP server IO";
-  auto lsp_io = OpenConnection(connection_mode, connection_arg);
-  if (!lsp_io.has_value()) {
-    Log << "Failed to open connection for LSP server.";
-    return false;
+  // The TCP server shuts down gracefully by reading these signals from a signalfd. A thread
+  // with them unblocked (such as the log flusher) would instead take the default action and
+  // kill the process, so they are blocked before any thread is spawned.
+  std::optional<ScopedShutdownSignalBlock> shutdown_signal_block;
+  if (connection_mode == ConnectionType::Port) {
+    shutdown_signal_block.emplace();
   }
 
-  Log << Trace << "Connection opened successfully";
+  std::optional<DuplexStream> lsp_io;
+
+  if (connection_mode == ConnectionType::Stdio) {
+    Log << Trace << "Opening connection for the LSP server IO";
+    lsp_io = OpenConnection(connection_mode, connection_arg);
+    if (!lsp_io.has_value()) {
+      Log << "Failed to open connection for LSP server.";
+      return false;
+    }
+
+    Log << Trace << "Connection opened successfully";
+  }
 
   bool lsp_status = false;
-  std::unique_ptr<std::fstream> log_stream;
+  std::unique_ptr<AsyncFileLogger> log_sink;
 
   { /* Open log output file */
     Log << Trace << "Opening log file: " << log_file;
-    log_stream = std::make_unique<std::fstream>(log_file, std::ios::out | std::ios::binary | std::ios::app);
-    if (!log_stream->is_open()) {
+    log_sink = AsyncFileLogger::Open(log_file);
+    if (log_sink == nullptr) {
       Log << "Failed to open log file: " << log_file;
       return false;
     }
     Log << Trace << "Log file opened successfully";
   }
 
-  auto file_logger = [&log_stream](const LogMessage& msg) {
-    auto message = msg.m_by.Format(msg.m_message, msg.m_sev);
-    log_stream->write(message.data(), message.size());
-    log_stream->write("\n", 1);
-    log_stream->flush();
-  };
+  // Formatting happens on the logging thread; the disk write happens on the sink's flusher thread
+  auto file_logger = [&log_sink](const LogMessage& msg) { log_sink->Write(msg.m_by.Format(msg.m_message, msg.m_sev)); };
 
   { /* Run the LSP server */
     if (connection_mode == ConnectionType::Stdio) {
@@ -273,12 +318,21 @@ static bool StartServer(const std::filesystem::path& log_file, const ConnectionT
     } else {
       const auto file_logger_id = Log->Subscribe(file_logger);
       Log << Info << "Starting LSP server with " << connection_mode << " connection";
-      lsp_status = Server(*lsp_io.value()).Start();
+
+      // Keep serving sessions so that the process (and everything it has cached) survives client reconnects.
+      lsp_status = ServeConnections(connection_mode, connection_arg, [](DuplexStream io) {
+        Log << Info << "Starting LSP session";
+        if (!Server(*io).Start()) {
+          Log << "LSP session failed";
+        }
+        Log << Info << "LSP session exited";
+      });
+
       Log << Info << "LSP server exited";
       Log->Unsubscribe(file_logger_id);
     }
 
-    log_stream = nullptr;
+    log_sink = nullptr;
   }
 
   if (!lsp_status) {
@@ -41,27 +41,64 @@
 using namespace ncc;
 using namespace no3::lsp;
 
+static auto ParseTcpPort(const std::string& target) -> std::optional<uint16_t> {
+  uint16_t port = 0;
+
+  std::from_chars_result res = std::from_chars(target.c_str(), target.c_str() + target.size(), port);
+  if (res.ec != std::errc()) {
+    Log << "Invalid port number: " << target;
+    return std::nullopt;
+  }
+
+  if (port > UINT16_MAX) {
+    Log << "Port number is out of the range of valid TCP ports";
+    return std::nullopt;
+  }
+
+  return port;
+}
+
 auto core::OpenConnection(ConnectionType type, const std::string& target) -> std::optional<DuplexStream> {
   switch (type) {
     case ConnectionType::Port: {
-      uint16_t port = 0;
-
-      std::from_chars_result res = std::from_chars(target.c_str(), target.c_str() + target.size(), port);
-      if (res.ec != std::errc()) {
-        Log << "Invalid port number: " << target;
-        return std::nullopt;
-      }
-
-      if (port > UINT16_MAX) {
-        Log << "Port number is out of the range of valid TCP ports";
+      auto port = ParseTcpPort(target);
+      if (!port.has_value()) {
         return std::nullopt;
       }
 
-      return ConnectToTcpPort(port);
+      return ConnectToTcpPort(*port);
     }
 
     case ConnectionType::Stdio: {
       return ConnectToStdio();
     }
+
+    case ConnectionType::Pipe: {
+      return ConnectToUnixSocket(target);
+    }
+  }
+}
+
+auto core::ServeConnections(ConnectionType type, const std::string& target, const SessionHandler& on_session) -> bool {
+  switch (type) {
+    case ConnectionType::Port: {
+      auto port = ParseTcpPort(target);
+      if (!port.has_value()) {
+        return false;
+      }
+
+      return ServeTcpPort(*port, on_session);
+    }
+
+    case ConnectionType::Stdio:
+    case ConnectionType::Pipe: {
+      auto io = OpenConnection(type, target);
+      if (!io.has_value()) {
+        return false;
+      }
+
+      on_session(std::move(io.value()));
+      return true;
+    }
   }
 }
@@ -33,18 +33,25 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
 
 namespace no3::lsp::core {
   using DuplexStream = std::unique_ptr<std::iostream>;
+  using SessionHandler = std::function<void(DuplexStream)>;
 
   auto ConnectToTcpPort(uint16_t tcp_port) -> std::optional<DuplexStream>;
   auto ConnectToStdio() -> std::optional<DuplexStream>;
+  auto ConnectToUnixSocket(const std::string& path) -> std::optional<DuplexStream>;
 
-  enum class ConnectionType : uint8_t { Port, Stdio };
+  /// Accept TCP clients until SIGINT/SIGTERM, running each session on its own thread.
+  auto ServeTcpPort(uint16_t tcp_port, const SessionHandler& on_session) -> bool;
+
+  enum class ConnectionType : uint8_t { Port, Stdio, Pipe };
   auto OpenConnection(ConnectionType type, const std::string& target) -> std::optional<DuplexStream>;
+  auto ServeConnections(ConnectionType type, const std::string& target, const SessionHandler& on_session) -> bool;
 
   static inline std::ostream& operator<<(std::ostream& os, const ConnectionType& type) {
     switch (type) {
@@ -52,6 +59,8 @@ namespace no3::lsp::core {
         return os << "Port";
       case ConnectionType::Stdio:
         return os << "Stdio";
+      case ConnectionType::Pipe:
+        return os << "Pipe";
     }
   }
 }  // namespace no3::lsp::core
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <nitrate-core/Assert.hh>
+#include <nitrate-core/Logger.hh>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+FileDescriptorStreamBuf::FileDescriptorStreamBuf(int in, int out, bool close, size_t buffer_size)
+    : m_in(in), m_out(out), m_close(close) {
+  qcore_assert(buffer_size > 0);
+
+  m_read_buffer.resize(buffer_size);
+  m_write_buffer.resize(buffer_size);
+
+  setg(m_read_buffer.data(), m_read_buffer.data(), m_read_buffer.data());
+  setp(m_write_buffer.data(), m_write_buffer.data() + m_write_buffer.size());
+}
+
+FileDescriptorStreamBuf::~FileDescriptorStreamBuf() {
+  FlushWriteBuffer();
+
+  if (m_close) {
+    if (m_in >= 0) {
+      close(m_in);
+    }
+
+    if (m_out >= 0 && m_out != m_in) {
+      close(m_out);
+    }
+  }
+}
+
+auto FileDescriptorStreamBuf::ReadSome(char* dst, size_t size) -> ssize_t {
+  ssize_t bytes_read;
+
+  do {
+    bytes_read = ::read(m_in, dst, size);
+    m_stats.m_read_syscalls.fetch_add(1, std::memory_order_relaxed);
+  } while (bytes_read < 0 && errno == EINTR);
+
+  if (bytes_read > 0) [[likely]] {
+    m_stats.m_bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
+  }
+
+  return bytes_read;
+}
+
+auto FileDescriptorStreamBuf::WriteVector(std::span<iovec> iov) -> bool {
+  while (!iov.empty()) {
+    if (iov.front().iov_len == 0) {
+      iov = iov.subspan(1);
+      continue;
+    }
+
+    auto bytes_written = ::writev(m_out, iov.data(), static_cast<int>(std::min<size_t>(iov.size(), IOV_MAX)));
+    m_stats.m_write_syscalls.fetch_add(1, std::memory_order_relaxed);
+
+    if (bytes_written < 0) [[unlikely]] {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      std::array<char, 256> err_buffer;
+      Log << "FileDescriptorStreamBuf: writev() failed: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+      return false;
+    }
+
+    m_stats.m_bytes_written.fetch_add(bytes_written, std::memory_order_relaxed);
+
+    // Skip over everything that the kernel accepted
+    auto remaining = static_cast<size_t>(bytes_written);
+    while (!iov.empty() && remaining >= iov.front().iov_len) {
+      remaining -= iov.front().iov_len;
+      iov = iov.subspan(1);
+    }
+
+    if (!iov.empty()) {
+      iov.front().iov_base = static_cast<char*>(iov.front().iov_base) + remaining;
+      iov.front().iov_len -= remaining;
+    }
+  }
+
+  return true;
+}
+
+auto FileDescriptorStreamBuf::FlushWriteBuffer() -> bool {
+  const auto pending = static_cast<size_t>(pptr() - pbase());
+  if (pending == 0) {
+    return true;
+  }
+
+  std::array iov = {iovec{.iov_base = pbase(), .iov_len = pending}};
+  const auto okay = WriteVector(iov);
+  setp(m_write_buffer.data(), m_write_buffer.data() + m_write_buffer.size());
+
+  return okay;
+}
+
+auto FileDescriptorStreamBuf::ShutdownInput() -> bool { return m_in >= 0 && ::shutdown(m_in, SHUT_RD) == 0; }
+
+auto FileDescriptorStreamBuf::WriteGather(std::span<iovec> iov) -> bool {
+  if (!FlushWriteBuffer()) [[unlikely]] {
+    return false;
+  }
+
+  return WriteVector(iov);
+}
+
+auto FileDescriptorStreamBuf::underflow() -> int_type {
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  auto bytes_read = ReadSome(m_read_buffer.data(), m_read_buffer.size());
+  if (bytes_read <= 0) {
+    return traits_type::eof();
+  }
+
+  setg(m_read_buffer.data(), m_read_buffer.data(), m_read_buffer.data() + bytes_read);
+
+  return traits_type::to_int_type(*gptr());
+}
+
+auto FileDescriptorStreamBuf::xsgetn(char_type* s, std::streamsize n) -> std::streamsize {
+  std::streamsize total = 0;
+
+  {  // Drain the read-ahead buffer first
+    const auto buffered = std::min<std::streamsize>(egptr() - gptr(), n);
+    std::memcpy(s, gptr(), buffered);
+    gbump(static_cast<int>(buffered));
+    total += buffered;
+  }
+
+  while (total < n) {
+    const auto remaining = static_cast<size_t>(n - total);
+
+    // Large payloads (e.g. a full document in didOpen) bypass the read-ahead buffer
+    if (remaining >= m_read_buffer.size()) {
+      auto bytes_read = ReadSome(s + total, remaining);
+      if (bytes_read <= 0) {
+        break;
+      }
+
+      total += bytes_read;
+      continue;
+    }
+
+    if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+      break;
+    }
+
+    const auto chunk = std::min<std::streamsize>(egptr() - gptr(), n - total);
+    std::memcpy(s + total, gptr(), chunk);
+    gbump(static_cast<int>(chunk));
+    total += chunk;
+  }
+
+  return total;
+}
+
+auto FileDescriptorStreamBuf::overflow(int_type c) -> int_type {
+  if (!FlushWriteBuffer()) [[unlikely]] {
+    return traits_type::eof();
+  }
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
+
+auto FileDescriptorStreamBuf::xsputn(const char_type* s, std::streamsize n) -> std::streamsize {
+  if (n <= epptr() - pptr()) [[likely]] {
+    std::memcpy(pptr(), s, n);
+    pbump(static_cast<int>(n));
+    return n;
+  }
+
+  // Gather the pending bytes and the new payload into a single syscall
+  std::array iov = {
+      iovec{.iov_base = pbase(), .iov_len = static_cast<size_t>(pptr() - pbase())},
+      iovec{.iov_base = const_cast<char_type*>(s), .iov_len = static_cast<size_t>(n)},
+  };
+
+  const auto okay = WriteVector(iov);
+  setp(m_write_buffer.data(), m_write_buffer.data() + m_write_buffer.size());
+
+  return okay ? n : 0;
+}
+
+auto FileDescriptorStreamBuf::sync() -> int { return FlushWriteBuffer() ? 0 : -1; }
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <streambuf>
+#include <vector>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Buffered duplex stream buffer over a pair of raw file descriptors.
+   *
+   * Reads are served from a large read-ahead buffer and writes are collected in
+   * a write-behind buffer which is only handed to the kernel when it is full or
+   * when the stream is flushed (i.e. once per LSP message). Writes that do not
+   * fit into the remaining buffer space are gathered together with the pending
+   * bytes into a single `writev` call.
+   */
+  class FileDescriptorStreamBuf final : public std::streambuf {
+  public:
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    struct Statistics {
+      std::atomic<uint64_t> m_read_syscalls = 0;
+      std::atomic<uint64_t> m_write_syscalls = 0;
+      std::atomic<uint64_t> m_bytes_read = 0;
+      std::atomic<uint64_t> m_bytes_written = 0;
+    };
+
+    FileDescriptorStreamBuf(int in, int out, bool close, size_t buffer_size = kDefaultBufferSize);
+    FileDescriptorStreamBuf(const FileDescriptorStreamBuf&) = delete;
+    FileDescriptorStreamBuf(FileDescriptorStreamBuf&&) = delete;
+    ~FileDescriptorStreamBuf() override;
+
+    [[nodiscard]] auto GetStatistics() const -> const Statistics& { return m_stats; }
+    [[nodiscard]] auto GetInputDescriptor() const -> int { return m_in; }
+    [[nodiscard]] auto GetOutputDescriptor() const -> int { return m_out; }
+
+    /// Wake up a reader blocked on the input descriptor. Only sockets support this.
+    [[nodiscard]] auto ShutdownInput() -> bool;
+
+    /// Flush any buffered output and then write all of `iov` with as few `writev` calls as possible.
+    [[nodiscard]] auto WriteGather(std::span<iovec> iov) -> bool;
+
+  protected:
+    auto underflow() -> int_type override;
+    auto overflow(int_type c) -> int_type override;
+    auto xsgetn(char_type* s, std::streamsize n) -> std::streamsize override;
+    auto xsputn(const char_type* s, std::streamsize n) -> std::streamsize override;
+    auto sync() -> int override;
+
+  private:
+    int m_in;
+    int m_out;
+    bool m_close;
+    std::vector<char> m_read_buffer;
+    std::vector<char> m_write_buffer;
+    Statistics m_stats;
+
+    auto ReadSome(char* dst, size_t size) -> ssize_t;
+    auto WriteVector(std::span<iovec> iov) -> bool;
+    auto FlushWriteBuffer() -> bool;
+  };
+
+  class FileDescriptorStream final : public std::iostream {
+    std::unique_ptr<FileDescriptorStreamBuf> m_buf;
+
+  public:
+    FileDescriptorStream(std::unique_ptr<FileDescriptorStreamBuf> buf)
+        : std::iostream(buf.get()), m_buf(std::move(buf)) {}
+    FileDescriptorStream(const FileDescriptorStream&) = delete;
+    FileDescriptorStream(FileDescriptorStream&&) = delete;
+    ~FileDescriptorStream() override = default;
+
+    [[nodiscard]] auto GetStreamBuf() const -> FileDescriptorStreamBuf& { return *m_buf; }
+  };
+}  // namespace no3::lsp::core
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <lsp/connect/Connection.hh>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <nitrate-core/Logger.hh>
+
+using namespace ncc;
+using namespace no3::lsp;
+
+static auto VerifyPeerCredentials(int fd) -> bool {
+  ucred peer = {};
+  socklen_t peer_size = sizeof(peer);
+
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peer_size) == -1) {
+    std::array<char, 256> err_buffer;
+    Log << "Failed to query peer credentials: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    return false;
+  }
+
+  Log << Trace << "Unix socket peer: pid=" << peer.pid << ", uid=" << peer.uid << ", gid=" << peer.gid;
+
+  if (peer.uid != geteuid() && peer.uid != 0) {
+    Log << "Refusing Unix socket peer owned by uid " << peer.uid << " (expected uid " << geteuid() << ")";
+    return false;
+  }
+
+  return true;
+}
+
+auto core::ConnectToUnixSocket(const std::string& path) -> std::optional<DuplexStream> {
+  std::array<char, 256> err_buffer;
+
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    Log << "Invalid Unix socket path: \"" << path << "\"";
+    return std::nullopt;
+  }
+
+  std::memcpy(addr.sun_path, path.data(), path.size());
+
+  Log << Trace << "Creating AF_UNIX socket";
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    Log << "Failed to create socket: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    return std::nullopt;
+  }
+
+  Log << Trace << "Connecting to Unix socket: " << path;
+
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    Log << "Failed to connect to Unix socket \"" << path
+        << "\": " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    close(fd);
+    return std::nullopt;
+  }
+
+  if (!VerifyPeerCredentials(fd)) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  auto io_stream =
+      std::make_unique<FileDescriptorStream>(std::make_unique<FileDescriptorStreamBuf>(fd, fd, true));
+  if (!io_stream->good()) {
+    Log << "Failed to open Unix socket iostreams";
+    return std::nullopt;
+  }
+
+  Log << Trace << "Connected to Unix socket: " << path;
+
+  return io_stream;
+}
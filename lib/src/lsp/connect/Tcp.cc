@@ -32,20 +32,29 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #include <unistd.h>
 
-#include <boost/iostreams/device/file_descriptor.hpp>
-#include <boost/iostreams/stream.hpp>
+#include <csignal>
+#include <list>
 #include <lsp/connect/Connection.hh>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <lsp/server/SessionTag.hh>
 #include <nitrate-core/Logger.hh>
+#include <thread>
 
 using namespace ncc;
 using namespace no3::lsp;
 
-static auto AcceptTcpClientConnection(const char* srv_host, uint16_t srv_port) -> std::optional<int> {
+static auto CreateListeningSocket(const char* srv_host, uint16_t srv_port) -> std::optional<int> {
   union SockAddrUnion {
     struct sockaddr_in m_in;
     struct sockaddr m_addr;
@@ -53,12 +62,11 @@ static auto AcceptTcpClientConnection(const char* srv_host, uint16_t srv_port) -
 
   std::array<char, 256> err_buffer;
   int fd = -1;
-  int client_fd = -1;
 
   {
     Log << Trace << "Creating TCP AF_INET socket";
 
-    fd = socket(AF_INET, SOCK_STREAM, 0);
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (fd == -1) {
       auto* error = strerror_r(errno, err_buffer.data(), err_buffer.size());
       Log << "Failed to create socket: " << error;
@@ -105,7 +113,7 @@ static auto AcceptTcpClientConnection(const char* srv_host, uint16_t srv_port) -
   }
 
   {
-    if (listen(fd, 1) == -1) {
+    if (listen(fd, SOMAXCONN) == -1) {
       close(fd);
 
       auto* error = strerror_r(errno, err_buffer.data(), err_buffer.size());
@@ -116,58 +124,235 @@ static auto AcceptTcpClientConnection(const char* srv_host, uint16_t srv_port) -
     Log << Trace << "Listening on TCP socket";
   }
 
-  {
-    Log << Info << "Waiting for TCP connection on: " << srv_host << ":" << srv_port;
+  return fd;
+}
 
-    client_fd = accept(fd, nullptr, nullptr);
-    if (client_fd == -1) {
-      close(fd);
+static void ConfigureClientSocket(int client_fd) {
+  // Responses are already coalesced by the writer thread, so don't let Nagle delay them.
+  int opt = 1;
+  if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1) {
+    Log << Warning << "Failed to set TCP_NODELAY on client socket";
+  }
+}
 
-      auto* error = strerror_r(errno, err_buffer.data(), err_buffer.size());
-      Log << "Failed to accept connection: " << error;
-      return std::nullopt;
-    }
+static auto CreateSocketStream(int client_fd, bool close) -> std::optional<core::DuplexStream> {
+  auto io_stream = std::make_unique<core::FileDescriptorStream>(
+      std::make_unique<core::FileDescriptorStreamBuf>(client_fd, client_fd, close));
 
-    Log << Info << "Accepted connection from client";
+  if (!io_stream->good()) {
+    Log << "Failed to open TCP iostreams";
+    return std::nullopt;
   }
 
-  {
-    Log << Trace << "Closing listening socket";
+  return io_stream;
+}
 
-    if (close(fd) == -1) {
-      close(client_fd);
+auto core::ConnectToTcpPort(uint16_t tcp_port) -> std::optional<DuplexStream> {
+  Log << Trace << "Creating temporary TCP server on port " << tcp_port;
+  auto listen_fd = CreateListeningSocket("0.0.0.0", tcp_port);
+  if (!listen_fd) {
+    Log << "Failed to create a TCP listening socket";
+    return std::nullopt;
+  }
 
-      auto* error = strerror_r(errno, err_buffer.data(), err_buffer.size());
-      Log << "Failed to close listening socket: " << error;
-      return std::nullopt;
-    }
+  Log << Info << "Waiting for TCP connection on: 0.0.0.0:" << tcp_port;
+
+  int client_fd = accept4(*listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+  close(*listen_fd);
 
-    Log << Trace << "Listening socket closed";
+  if (client_fd == -1) {
+    std::array<char, 256> err_buffer;
+    Log << "Failed to accept connection: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    return std::nullopt;
   }
 
-  Log << Trace << "Returning client socket: " << client_fd;
+  Log << Info << "Accepted connection from client";
+  ConfigureClientSocket(client_fd);
 
-  return client_fd;
+  return CreateSocketStream(client_fd, true);
 }
 
-auto core::ConnectToTcpPort(uint16_t tcp_port) -> std::optional<DuplexStream> {
-  Log << Trace << "Creating temporary TCP server on port " << tcp_port;
-  auto conn = AcceptTcpClientConnection("0.0.0.0", tcp_port);
-  if (!conn) {
-    Log << "Failed to accept a TCP client connection";
-    return std::nullopt;
+namespace {
+  struct TcpSession {
+    size_t m_id;
+    int m_fd;
+    std::atomic<bool> m_finished = false;
+    std::jthread m_thread;
+
+    TcpSession(size_t id, int fd) : m_id(id), m_fd(fd) {}
+  };
+}  // namespace
+
+auto core::ServeTcpPort(uint16_t tcp_port, const SessionHandler& on_session) -> bool {
+  std::array<char, 256> err_buffer;
+
+  auto listen_fd = CreateListeningSocket("0.0.0.0", tcp_port);
+  if (!listen_fd) {
+    Log << "Failed to create a TCP listening socket";
+    return false;
   }
 
-  Log << Trace << "Creating boost::iostreams::stream from raw file descriptor";
-  auto source = boost::iostreams::file_descriptor(conn.value(), boost::iostreams::close_handle);
-  auto io_stream = std::make_unique<boost::iostreams::stream<boost::iostreams::file_descriptor>>((source));
+  if (fcntl(*listen_fd, F_SETFL, fcntl(*listen_fd, F_GETFL) | O_NONBLOCK) == -1) {
+    close(*listen_fd);
+    Log << "Failed to make the listening socket non-blocking: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    return false;
+  }
 
-  if (!io_stream->is_open()) {
-    Log << "Failed to open TCP iostreams";
-    return std::nullopt;
+  // Route SIGINT and SIGTERM through the event loop for a graceful shutdown. The mask is
+  // inherited by the session threads, but threads spawned earlier keep their own; callers
+  // must block these signals before starting any thread (see StartServer()).
+  sigset_t signals;
+  sigset_t old_signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+
+  const int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC | SFD_NONBLOCK);
+  const int session_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+  const auto cleanup_descriptors = [&]() {
+    for (int fd : {epoll_fd, session_event_fd, signal_fd, *listen_fd}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_signals, nullptr);
+  };
+
+  if (signal_fd == -1 || session_event_fd == -1 || epoll_fd == -1) {
+    Log << "Failed to create the TCP event loop: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+    cleanup_descriptors();
+    return false;
   }
 
-  Log << Trace << "Connected to a TCP client";
+  for (int fd : {*listen_fd, signal_fd, session_event_fd}) {
+    epoll_event event = {.events = EPOLLIN, .data = {.fd = fd}};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+      Log << "Failed to register with epoll: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+      cleanup_descriptors();
+      return false;
+    }
+  }
 
-  return io_stream;
+  Log << Info << "Waiting for TCP connections on: 0.0.0.0:" << tcp_port;
+
+  std::list<TcpSession> sessions;
+  size_t next_session_id = 1;  // Tag 0 is for threads outside any session
+  bool stop_requested = false;
+
+  const auto reap_finished_sessions = [&]() {
+    sessions.remove_if([](TcpSession& session) {
+      if (!session.m_finished) {
+        return false;
+      }
+
+      session.m_thread.join();
+      close(session.m_fd);
+      Log << Info << "TCP session #" << session.m_id << " closed";
+
+      return true;
+    });
+  };
+
+  const auto accept_clients = [&]() {
+    while (true) {
+      sockaddr_in peer = {};
+      socklen_t peer_size = sizeof(peer);
+
+      int client_fd = accept4(*listen_fd, reinterpret_cast<sockaddr*>(&peer), &peer_size, SOCK_CLOEXEC);
+      if (client_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+          Log << "Failed to accept connection: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+        }
+
+        return;
+      }
+
+      ConfigureClientSocket(client_fd);
+
+      auto stream = CreateSocketStream(client_fd, false);
+      if (!stream) {
+        close(client_fd);
+        continue;
+      }
+
+      std::array<char, INET_ADDRSTRLEN> peer_name = {};
+      inet_ntop(AF_INET, &peer.sin_addr, peer_name.data(), peer_name.size());
+
+      auto& session = sessions.emplace_back(next_session_id++, client_fd);
+      Log << Info << "TCP session #" << session.m_id << " accepted from " << peer_name.data() << ":"
+          << ntohs(peer.sin_port);
+
+      session.m_thread = std::jthread([&on_session, &session, session_event_fd, parent_thread_logger = Log,
+                                       stream = std::move(stream.value())]() mutable {
+        // Use the logger from the parent thread, but keep this session's log lines apart from the others'
+        Log = parent_thread_logger;
+        SetThreadSessionTag(session.m_id);
+
+        on_session(std::move(stream));
+
+        session.m_finished = true;
+        uint64_t one = 1;
+        (void)!write(session_event_fd, &one, sizeof(one));
+      });
+    }
+  };
+
+  bool event_loop_failed = false;
+
+  while (!stop_requested) {
+    std::array<epoll_event, 16> events;
+
+    const auto count = epoll_wait(epoll_fd, events.data(), events.size(), -1);
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      Log << "epoll_wait() failed: " << strerror_r(errno, err_buffer.data(), err_buffer.size());
+      event_loop_failed = true;
+      break;
+    }
+
+    for (int i = 0; i < count; ++i) {
+      const auto fd = events[i].data.fd;
+
+      if (fd == *listen_fd) {
+        accept_clients();
+      } else if (fd == session_event_fd) {
+        uint64_t ignored;
+        (void)!read(session_event_fd, &ignored, sizeof(ignored));
+        reap_finished_sessions();
+      } else if (fd == signal_fd) {
+        signalfd_siginfo info;
+        (void)!read(signal_fd, &info, sizeof(info));
+        Log << Info << "Received signal " << info.ssi_signo << ", shutting down the TCP server";
+        stop_requested = true;
+      }
+    }
+  }
+
+  {  // Wake up sessions that are blocked on their sockets and wait for them to finish
+    for (auto& session : sessions) {
+      if (!session.m_finished) {
+        shutdown(session.m_fd, SHUT_RDWR);
+      }
+    }
+
+    for (auto& session : sessions) {
+      session.m_thread.join();
+      close(session.m_fd);
+    }
+
+    sessions.clear();
+  }
+
+  cleanup_descriptors();
+
+  Log << Info << "TCP server stopped";
+
+  return !event_loop_failed;
 }
@@ -33,7 +33,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/flyweight.hpp>
+#include <mutex>
+#include <nitrate-core/Logger.hh>
 #include <nlohmann/json.hpp>
 
 namespace no3::lsp::message {
@@ -43,15 +46,44 @@ namespace no3::lsp::message {
     Notification,
   };
 
+  /// Unparsed JSON text, turned into a DOM only if someone asks for it.
+  struct RawJson {
+    std::string m_text;
+  };
+
   class Message {
     MessageKind m_kind;
-    nlohmann::json m_json;
+    mutable nlohmann::json m_json;
+    /// Kept until destruction so views handed out by `GetRawJson()` stay valid while another thread materializes.
+    std::string m_raw;
+    mutable std::once_flag m_materialize_once;
+    mutable std::atomic<bool> m_is_materialized = false;
+
+    void Materialize() const {
+      std::call_once(m_materialize_once, [this] {
+        if (!m_is_materialized.load(std::memory_order_relaxed) && !m_raw.empty()) [[unlikely]] {
+          m_json = nlohmann::json::parse(m_raw, nullptr, false);
+          if (m_json.is_discarded()) [[unlikely]] {
+            ncc::Log << "Message: Failed to parse params of " << GetMethod() << "; treating them as null";
+            m_json = nullptr;
+          }
+        }
+
+        m_is_materialized.store(true, std::memory_order_release);
+      });
+    }
 
   public:
-    Message(MessageKind kind) : m_kind(kind){};
-    Message(MessageKind kind, nlohmann::json json) : m_kind(kind), m_json(std::move(json)) {}
+    Message(MessageKind kind) : m_kind(kind), m_is_materialized(true){};
+    Message(MessageKind kind, nlohmann::json json) : m_kind(kind), m_json(std::move(json)), m_is_materialized(true) {}
+    Message(MessageKind kind, RawJson raw) : m_kind(kind), m_raw(std::move(raw.m_text)) {}
     Message(const Message&) = delete;
-    Message(Message&&) = default;
+    /// Only while the message is not shared yet.
+    Message(Message&& other) noexcept
+        : m_kind(other.m_kind),
+          m_json(std::move(other.m_json)),
+          m_raw(std::move(other.m_raw)),
+          m_is_materialized(other.m_is_materialized.load(std::memory_order_relaxed)) {}
     virtual ~Message() = default;
 
     [[nodiscard]] auto GetKind() const -> MessageKind { return m_kind; }
@@ -61,10 +93,30 @@ namespace no3::lsp::message {
 
     [[nodiscard]] virtual auto GetMethod() const -> std::string_view { return ""; }
 
-    [[nodiscard]] auto operator->() const -> const nlohmann::json* { return &m_json; }
-    [[nodiscard]] auto operator->() -> nlohmann::json* { return &m_json; }
-    [[nodiscard]] auto operator*() const -> const nlohmann::json& { return m_json; }
-    [[nodiscard]] auto operator*() -> nlohmann::json& { return m_json; }
+    /// The unparsed JSON text, or empty once the DOM has been materialized (and may have been edited).
+    [[nodiscard]] auto GetRawJson() const -> std::string_view {
+      return m_is_materialized.load(std::memory_order_acquire) ? std::string_view() : m_raw;
+    }
+
+    [[nodiscard]] auto operator->() const -> const nlohmann::json* {
+      Materialize();
+      return &m_json;
+    }
+
+    [[nodiscard]] auto operator->() -> nlohmann::json* {
+      Materialize();
+      return &m_json;
+    }
+
+    [[nodiscard]] auto operator*() const -> const nlohmann::json& {
+      Materialize();
+      return m_json;
+    }
+
+    [[nodiscard]] auto operator*() -> nlohmann::json& {
+      Materialize();
+      return m_json;
+    }
 
     virtual auto Finalize() -> Message& = 0;
   };
@@ -38,18 +38,17 @@
 namespace no3::lsp::message {
   class NotifyMessage : public Message {
     std::string m_method;
-    nlohmann::json m_params;
 
   public:
     NotifyMessage(std::string method, nlohmann::json params)
-        : Message(MessageKind::Notification, std::move(params)),
-          m_method(std::move(method)),
-          m_params(std::move(params)) {}
+        : Message(MessageKind::Notification, std::move(params)), m_method(std::move(method)) {}
+    NotifyMessage(std::string method, RawJson params)
+        : Message(MessageKind::Notification, std::move(params)), m_method(std::move(method)) {}
     NotifyMessage(const NotifyMessage&) = delete;
     NotifyMessage(NotifyMessage&&) = default;
     ~NotifyMessage() override = default;
 
-    [[nodiscard]] auto GetParams() const -> const nlohmann::json& { return m_params; }
+    [[nodiscard]] auto GetParams() const -> const nlohmann::json& { return **this; }
     [[nodiscard]] auto GetMethod() const -> std::string_view override { return m_method; }
 
     auto Finalize() -> NotifyMessage& override {
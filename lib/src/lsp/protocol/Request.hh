@@ -36,17 +36,23 @@
 #include <lsp/protocol/Message.hh>
 #include <lsp/protocol/Response.hh>
 #include <lsp/protocol/StatusCode.hh>
+#include <stop_token>
 
 namespace no3::lsp::message {
   class RequestMessage : public Message {
     std::string m_method;
     MessageSequenceID m_request_id;
+    std::stop_token m_stop_token;
 
   public:
     RequestMessage(std::string method, MessageSequenceID request_id, nlohmann::json params)
         : Message(MessageKind::Request, std::move(params)),
           m_method(std::move(method)),
           m_request_id(std::move(request_id)) {}
+    RequestMessage(std::string method, MessageSequenceID request_id, RawJson params)
+        : Message(MessageKind::Request, std::move(params)),
+          m_method(std::move(method)),
+          m_request_id(std::move(request_id)) {}
     RequestMessage(const RequestMessage&) = delete;
     RequestMessage(RequestMessage&&) = default;
     ~RequestMessage() override = default;
@@ -57,6 +63,11 @@ namespace no3::lsp::message {
 
     [[nodiscard]] auto GetResponseObject() const -> ResponseMessage { return {m_request_id}; }
 
+    /// Tripped when the client sends `$/cancelRequest` for this request.
+    void SetStopToken(std::stop_token stop_token) { m_stop_token = std::move(stop_token); }
+    [[nodiscard]] auto GetStopToken() const -> const std::stop_token& { return m_stop_token; }
+    [[nodiscard]] auto IsCancelled() const -> bool { return m_stop_token.stop_requested(); }
+
     auto Finalize() -> RequestMessage& override { return *this; }
   };
 }  // namespace no3::lsp::message
@@ -35,10 +35,15 @@
 
 #include <cstdint>
 #include <lsp/protocol/Base.hh>
+#include <optional>
+#include <string>
 
 namespace no3::lsp::protocol {
   enum class TextDocumentSyncKind { None = 0, Full = 1, Incremental = 2 };
 
+  /// Unit of `Position::m_character`, agreed on during `initialize`.
+  enum class PositionEncoding : uint8_t { UTF8, UTF16 };
+
   struct Position {
     uint64_t m_line;
     uint64_t m_character;
@@ -50,7 +55,7 @@ namespace no3::lsp::protocol {
   };
 
   struct TextDocumentContentChangeEvent {
-    Range m_range;
-    core::FlyByteString m_text;
+    std::optional<Range> m_range;  // None: replaces the whole document
+    std::basic_string<uint8_t> m_text;
   };
 }  // namespace no3::lsp::protocol
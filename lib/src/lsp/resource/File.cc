@@ -31,14 +31,18 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <istream>
 #include <lsp/protocol/Base.hh>
 #include <lsp/resource/File.hh>
+#include <lsp/resource/TextKernels.hh>
 #include <memory>
+#include <mutex>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
+#include <optional>
 #include <string_view>
 
 using namespace ncc;
@@ -47,16 +51,35 @@ using namespace no3::lsp::core;
 class ConstFile::PImpl {
 public:
   FlyString m_file_uri;
-  FlyByteString m_raw;
+  Rope m_content;
   FileVersion m_version;
 
-  PImpl(FlyString file_uri, FileVersion version, FlyByteString raw)
-      : m_file_uri(std::move(file_uri)), m_raw(std::move(raw)), m_version(version) {}
+  std::once_flag m_flattened;
+  std::optional<FlyByteString> m_raw;
+
+  PImpl(FlyString file_uri, FileVersion version, Rope content)
+      : m_file_uri(std::move(file_uri)), m_content(std::move(content)), m_version(version) {}
   PImpl(const PImpl &) = delete;
+
+  auto GetRaw() -> const FlyByteString & {
+    std::call_once(m_flattened, [this] {
+      if (!m_raw.has_value()) {
+        m_raw = FlyByteString(m_content.ToBytes());
+      }
+    });
+
+    return *m_raw;
+  }
 };
 
 ConstFile::ConstFile(FlyString file_uri, FileVersion version, FlyByteString raw)
-    : m_impl(std::make_unique<PImpl>(std::move(file_uri), version, std::move(raw))) {}
+    : m_impl(std::make_unique<PImpl>(std::move(file_uri), version, Rope(Rope::BytesView(raw->data(), raw->size())))) {
+  // Already interned; keep it rather than flattening the rope again on `ReadAll()`
+  m_impl->m_raw = std::move(raw);
+}
+
+ConstFile::ConstFile(FlyString file_uri, FileVersion version, Rope content)
+    : m_impl(std::make_unique<PImpl>(std::move(file_uri), version, std::move(content))) {}
 
 ConstFile::~ConstFile() = default;
 
@@ -72,176 +95,175 @@ auto ConstFile::GetURI() const -> FlyString {
 
 auto ConstFile::GetFileSizeInBytes() const -> std::streamsize {
   qcore_assert(m_impl != nullptr);
-  return m_impl->m_raw->size();
+  return m_impl->m_content.Size();
 }
 
 auto ConstFile::GetFileSizeInKiloBytes() const -> std::streamsize { return GetFileSizeInBytes() / 1000; }
 auto ConstFile::GetFileSizeInMegaBytes() const -> std::streamsize { return GetFileSizeInKiloBytes() / 1000; }
 auto ConstFile::GetFileSizeInGigaBytes() const -> std::streamsize { return GetFileSizeInMegaBytes() / 1000; }
 
+auto ConstFile::GetContent() const -> const Rope & {
+  qcore_assert(m_impl != nullptr);
+  return m_impl->m_content;
+}
+
 auto ConstFile::ReadAll() const -> FlyByteString {
   qcore_assert(m_impl != nullptr);
-  return m_impl->m_raw;
+  return m_impl->GetRaw();
 }
 
 auto ConstFile::GetReader() const -> std::unique_ptr<std::basic_istream<uint8_t>> {
   qcore_assert(m_impl != nullptr);
-  const auto &data = m_impl->m_raw;
+  const auto &data = m_impl->GetRaw();
 
   return std::make_unique<boost::iostreams::stream<boost::iostreams::basic_array_source<uint8_t>>>(data->data(),
                                                                                                    data->size());
 }
 
-struct UnicodeResult {
-  uint8_t m_count;
-  uint8_t m_size;
-};
-
-static auto UTF8ToUTF16CharacterCount(std::basic_string_view<uint8_t> utf8_bytes) -> std::optional<UnicodeResult> {
-  std::array<uint8_t, 4> utf8_buf;
-  uint32_t codepoint = 0;
-  uint8_t codepoint_size = 0;
-
-  utf8_buf.fill(0);
-  std::memcpy(utf8_buf.data(), utf8_bytes.data(), utf8_bytes.size() < 4 ? utf8_bytes.size() : 4);
-
-  if ((utf8_buf[0] & 0x80) == 0) [[likely]] {
-    codepoint = utf8_buf[0];
-    codepoint_size = 1;
-  } else if ((utf8_buf[0] & 0xE0) == 0xC0) {
-    codepoint = (utf8_buf[0] & 0x1F) << 6 | (utf8_buf[1] & 0x3F);
-    codepoint_size = 2;
-  } else if ((utf8_buf[0] & 0xF0) == 0xE0) {
-    codepoint = (utf8_buf[0] & 0x0F) << 12 | (utf8_buf[1] & 0x3F) << 6 | (utf8_buf[2] & 0x3F);
-    codepoint_size = 3;
-  } else if ((utf8_buf[0] & 0xF8) == 0xF0) {
-    codepoint =
-        (utf8_buf[0] & 0x07) << 18 | (utf8_buf[1] & 0x3F) << 12 | (utf8_buf[2] & 0x3F) << 6 | (utf8_buf[3] & 0x3F);
-    codepoint_size = 4;
-  } else {
-    return std::nullopt;
-  }
+/// Byte offset of `column` within `line`, clipped to the line's end.
+static auto GetColumnOffset(std::basic_string_view<uint8_t> line, uint64_t column,
+                            ConstFile::Encoding encoding) -> uint64_t {
+  if (encoding == ConstFile::Encoding::UTF8) {
+    if (column > line.size()) {
+      Log << Trace << "ConvertLCToOffset: Clipping UTF-8 column (" << column << ") to line length (" << line.size()
+          << ")";
+    }
 
-  // Can be stored in a single UTF-16 code unit
-  if (codepoint < 0xD800 || (codepoint > 0xDFFF && codepoint < 0x10000)) {
-    return {{1, codepoint_size}};
+    return std::min<uint64_t>(column, line.size());
   }
 
-  // Surrogate pair
-  if (codepoint >= 0x10000 && codepoint <= 0x10FFFF) {
-    return {{2, codepoint_size}};
+  const auto column_offset = text::FindUTF16Column(line, column);
+  if (column_offset == line.size()) {
+    if (const auto line_units = text::CountUTF16Units(line); line_units != column) {
+      Log << Trace << "ConvertLCToOffset: Clipping UTF-16 column (" << column << ") to line length (" << line_units
+          << ")";
+    }
   }
 
-  return std::nullopt;
+  return column_offset;
 }
 
-auto ConstFile::GetOffset(std::basic_string_view<uint8_t> raw, uint64_t line,
-                          uint64_t column) -> std::optional<uint64_t> {
+auto ConstFile::GetOffset(std::basic_string_view<uint8_t> raw, uint64_t line, uint64_t column,
+                          Encoding encoding) -> std::optional<uint64_t> {
   uint64_t raw_offset = 0;
-  const auto utf8_bytes_size = raw.size();
-
-  {  // Skip until the target line, else return std::nullopt if EOF
-    uint64_t current_line = 0;
 
-    while (true) {
-      if (current_line == line) {
-        break;
-      }
+  // Skip until the target line, else return std::nullopt if EOF
+  for (uint64_t current_line = 0; current_line < line; ++current_line) {
+    raw_offset += text::FindLineBreak(raw.substr(raw_offset));
+    if (raw_offset >= raw.size()) [[unlikely]] {
+      Log << "ConvertLCToOffset: Offset is out of bounds";
+      return std::nullopt;
+    }
 
-      if (raw_offset >= utf8_bytes_size) [[unlikely]] {
-        Log << "ConvertUTF16LCToOffset: Offset is out of bounds";
-        return std::nullopt;
-      }
+    /**
+     * @ref https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#textDocuments
+     *
+     * export const EOL: string[] = ['\n', '\r\n', '\r'];
+     */
 
-      /**
-       * @ref https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#textDocuments
-       *
-       * export const EOL: string[] = ['\n', '\r\n', '\r'];
-       */
-
-      const auto ch = raw[raw_offset++];
-      if (ch == '\r') {
-        if (raw_offset < utf8_bytes_size && raw[raw_offset] == '\n') {
-          ++raw_offset;
-        }
-
-        ++current_line;
-      } else if (ch == '\n') {
-        ++current_line;
-      }
+    if (raw[raw_offset] == '\r' && raw_offset + 1 < raw.size() && raw[raw_offset + 1] == '\n') {
+      ++raw_offset;
     }
 
-    // raw_byte_offset: is pointing to the first byte after the line break
-    qcore_assert(current_line == line);
+    ++raw_offset;
   }
 
-  uint64_t utf16_line_pos = 0;
-  for (auto &i = raw_offset; i < raw.size() && (raw[i] != '\n' && raw[i] != '\r'); ++i) {
-    if (column == utf16_line_pos) {
-      return raw_offset;
-    }
+  const auto line_bytes = raw.substr(raw_offset, text::FindLineBreak(raw.substr(raw_offset)));
 
-    if (auto res = UTF8ToUTF16CharacterCount(raw.substr(i))) {
-      utf16_line_pos += res->m_count;
-      i += res->m_size - 1;
-    }
+  return raw_offset + GetColumnOffset(line_bytes, column, encoding);
+}
+
+auto ConstFile::GetLC(std::basic_string_view<uint8_t> raw, uint64_t offset,
+                      Encoding encoding) -> std::optional<std::pair<uint64_t, uint64_t>> {
+  // An offset between the CR and LF of a pair is not a position
+  const auto splits_crlf = offset != 0 && offset < raw.size() && raw[offset - 1] == '\r' && raw[offset] == '\n';
+  if (offset > raw.size() || splits_crlf) [[unlikely]] {
+    Log << Trace << "ConvertOffsetToLC: Offset is out of bounds";
+    return std::nullopt;
   }
 
-  if (raw_offset == raw.size() && column != utf16_line_pos) {
-    Log << Trace << "ConvertUTF16LCToOffset: Clipping UTF-16 column (" << column << ") to line length ("
-        << utf16_line_pos << ")";
+  const auto prefix = raw.substr(0, offset);
+
+  uint64_t line_start = offset;
+  while (line_start != 0 && prefix[line_start - 1] != '\n' && prefix[line_start - 1] != '\r') {
+    --line_start;
   }
 
-  qcore_assert(raw_offset <= raw.size());
+  const auto line_prefix = prefix.substr(line_start);
+  const auto column = encoding == Encoding::UTF8 ? line_prefix.size() : text::CountUTF16Units(line_prefix);
 
-  return raw_offset;
+  return std::make_pair(text::CountLineBreaks(prefix), column);
 }
 
-auto ConstFile::GetLC(std::basic_string_view<uint8_t> raw,
-                      uint64_t offset) -> std::optional<std::pair<uint64_t, uint64_t>> {
-  uint64_t line = 0;
-  uint64_t column = 0;
-  uint64_t i = 0;
-
-  for (; i < offset && i < raw.size(); ++i) {
-    const auto ch = raw[i];
-    if (ch == '\r') {
-      if (i + 1 < raw.size() && raw[i + 1] == '\n') {
-        ++i;
-      }
+auto ConstFile::GetOffset(const Rope &content, uint64_t line, uint64_t column,
+                          Encoding encoding) -> std::optional<uint64_t> {
+  // A descent of the rope's line index; no bytes before the target line are touched
+  const auto line_start_opt = content.GetLineStart(line);
+  if (!line_start_opt.has_value()) [[unlikely]] {
+    Log << "ConvertLCToOffset: Offset is out of bounds";
+    return std::nullopt;
+  }
 
-      ++line;
-      column = 0;
-    } else if (ch == '\n') {
-      ++line;
-      column = 0;
-    } else {
-      ++column;
+  const auto line_start = *line_start_opt;
+
+  uint64_t line_size = 0;
+  content.ForEachChunk(line_start, content.Size() - line_start, [&](Rope::BytesView chunk) {
+    const auto run = text::FindLineBreak(chunk);
+    line_size += run;
+
+    // Byte columns need only the line length; stop once it is known to reach the column
+    return run == chunk.size() && (encoding == Encoding::UTF16 || line_size < column);
+  });
+
+  if (encoding == Encoding::UTF8) {
+    if (column > line_size) {
+      Log << Trace << "ConvertLCToOffset: Clipping UTF-8 column (" << column << ") to line length (" << line_size
+          << ")";
     }
+
+    return line_start + std::min<uint64_t>(column, line_size);
   }
 
-  if (i != offset) [[unlikely]] {
-    Log << Trace << "ConvertUTF16OffsetToLC: Offset is out of bounds";
+  // Only the target line is copied; the column math runs on it alone
+  const auto line_bytes = content.Substr(line_start, line_size);
+
+  return line_start + GetColumnOffset(line_bytes, column, encoding);
+}
+
+auto ConstFile::GetLC(const Rope &content, uint64_t offset,
+                      Encoding encoding) -> std::optional<std::pair<uint64_t, uint64_t>> {
+  if (offset > content.Size()) [[unlikely]] {
+    Log << Trace << "ConvertOffsetToLC: Offset is out of bounds";
     return std::nullopt;
   }
 
-  return std::make_pair(line, column);
-}
+  const auto line = content.CountLineBreaks(offset);
+  const auto line_start = content.GetLineStart(line);
 
-auto ConstFile::GetOffset(uint64_t line, uint64_t column) -> std::optional<uint64_t> {
-  qcore_assert(m_impl != nullptr);
+  // Past the end only when the offset splits a CRLF pair
+  if (!line_start.has_value() || *line_start > offset) [[unlikely]] {
+    Log << Trace << "ConvertOffsetToLC: Offset is out of bounds";
+    return std::nullopt;
+  }
 
-  const auto &raw = m_impl->m_raw;
-  const auto utf8_bytes = std::basic_string_view<uint8_t>(raw->data(), raw->size());
+  uint64_t column = offset - *line_start;
+  if (encoding == Encoding::UTF16) {
+    column = 0;
+    content.ForEachChunk(*line_start, offset - *line_start, [&](Rope::BytesView chunk) {
+      column += text::CountUTF16Units(chunk);
+      return true;
+    });
+  }
 
-  return GetOffset(utf8_bytes, line, column);
+  return std::make_pair(line, column);
 }
 
-auto ConstFile::GetLC(uint64_t offset) -> std::optional<std::pair<uint64_t, uint64_t>> {
+auto ConstFile::GetOffset(uint64_t line, uint64_t column, Encoding encoding) -> std::optional<uint64_t> {
   qcore_assert(m_impl != nullptr);
+  return GetOffset(m_impl->m_content, line, column, encoding);
+}
 
-  const auto &raw = m_impl->m_raw;
-  const auto utf8_bytes = std::basic_string_view<uint8_t>(raw->data(), raw->size());
-
-  return GetLC(utf8_bytes, offset);
+auto ConstFile::GetLC(uint64_t offset, Encoding encoding) -> std::optional<std::pair<uint64_t, uint64_t>> {
+  qcore_assert(m_impl != nullptr);
+  return GetLC(m_impl->m_content, offset, encoding);
 }
@@ -36,6 +36,8 @@
 #include <boost/flyweight.hpp>
 #include <istream>
 #include <lsp/protocol/Base.hh>
+#include <lsp/protocol/TextDocument.hh>
+#include <lsp/resource/Rope.hh>
 #include <memory>
 #include <string_view>
 
@@ -48,6 +50,7 @@ namespace no3::lsp::core {
 
   public:
     ConstFile(FlyString file_uri, FileVersion version, FlyByteString raw);
+    ConstFile(FlyString file_uri, FileVersion version, Rope content);
     ConstFile(const ConstFile&) = delete;
     ConstFile(ConstFile&&) = default;
     ConstFile& operator=(const ConstFile&) = delete;
@@ -61,15 +64,27 @@ namespace no3::lsp::core {
     [[nodiscard]] auto GetFileSizeInMegaBytes() const -> std::streamsize;
     [[nodiscard]] auto GetFileSizeInGigaBytes() const -> std::streamsize;
 
+    /// Shares structure with neighbouring versions; prefer this over `ReadAll()` on hot paths.
+    [[nodiscard]] auto GetContent() const -> const Rope&;
+
+    /// Flattened and interned on first use.
     [[nodiscard]] auto ReadAll() const -> FlyByteString;
     [[nodiscard]] auto GetReader() const -> std::unique_ptr<std::basic_istream<uint8_t>>;
 
-    static auto GetOffset(std::basic_string_view<uint8_t> raw, uint64_t line,
-                          uint64_t column) -> std::optional<uint64_t>;
-    static auto GetLC(std::basic_string_view<uint8_t> raw,
-                      uint64_t offset) -> std::optional<std::pair<uint64_t, uint64_t>>;
+    using Encoding = protocol::PositionEncoding;
+
+    /// Columns count `encoding` units; with UTF-8 they are byte offsets within the line.
+    static auto GetOffset(std::basic_string_view<uint8_t> raw, uint64_t line, uint64_t column,
+                          Encoding encoding = Encoding::UTF16) -> std::optional<uint64_t>;
+    static auto GetLC(std::basic_string_view<uint8_t> raw, uint64_t offset,
+                      Encoding encoding = Encoding::UTF16) -> std::optional<std::pair<uint64_t, uint64_t>>;
+
+    static auto GetOffset(const Rope& content, uint64_t line, uint64_t column,
+                          Encoding encoding = Encoding::UTF16) -> std::optional<uint64_t>;
+    static auto GetLC(const Rope& content, uint64_t offset,
+                      Encoding encoding = Encoding::UTF16) -> std::optional<std::pair<uint64_t, uint64_t>>;
 
-    auto GetOffset(uint64_t line, uint64_t column) -> std::optional<uint64_t>;
-    auto GetLC(uint64_t offset) -> std::optional<std::pair<uint64_t, uint64_t>>;
+    auto GetOffset(uint64_t line, uint64_t column, Encoding encoding = Encoding::UTF16) -> std::optional<uint64_t>;
+    auto GetLC(uint64_t offset, Encoding encoding = Encoding::UTF16) -> std::optional<std::pair<uint64_t, uint64_t>>;
   };
 }  // namespace no3::lsp::core
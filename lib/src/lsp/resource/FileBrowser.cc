@@ -31,7 +31,10 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
+#include <core/trace/Trace.hh>
 #include <lsp/resource/FileBrowser.hh>
+#include <lsp/resource/TextKernels.hh>
 #include <memory>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
@@ -44,6 +47,7 @@ class FileBrowser::PImpl {
 public:
   std::mutex m_mutex;
   std::unordered_map<FlyString, std::shared_ptr<ConstFile>> m_files;
+  std::atomic<protocol::PositionEncoding> m_encoding = protocol::PositionEncoding::UTF16;
 };
 
 FileBrowser::FileBrowser(protocol::TextDocumentSyncKind) : m_impl(std::make_unique<PImpl>()) {}
@@ -51,29 +55,15 @@ FileBrowser::FileBrowser(protocol::TextDocumentSyncKind) : m_impl(std::make_uniq
 FileBrowser::~FileBrowser() = default;
 
 static auto TransformUTF8ToLF(const FlyByteString& raw) -> FlyByteString {
-  const auto& utf8_bytes = *raw;
-
   std::basic_string<uint8_t> result;
-  result.reserve(utf8_bytes.size());
-
-  for (uint64_t i = 0; i < utf8_bytes.size(); ++i) {
-    const auto ch = utf8_bytes[i];
-
-    if (ch == '\r') {
-      if (i + 1 < utf8_bytes.size() && utf8_bytes[i + 1] == '\n') {
-        ++i;
-      }
-      result.push_back('\n');
-    } else {
-      result.push_back(ch);
-    }
-  }
+  text::NormalizeToLF(*raw, result);
 
   return FlyByteString(std::move(result));
 }
 
 auto FileBrowser::DidOpen(const FlyString& file_uri, FileVersion version, FlyByteString raw) -> bool {
   qcore_assert(m_impl != nullptr);
+  NO3_TRACE_SPAN("lsp.fs", "FileBrowser::DidOpen");
   std::lock_guard lock(m_impl->m_mutex);
 
   Log << Trace << "FileBrowser::DidOpen(" << file_uri << ", " << version << ", " << raw->size() << " bytes)";
@@ -95,6 +85,7 @@ auto FileBrowser::DidOpen(const FlyString& file_uri, FileVersion version, FlyByt
 
 auto FileBrowser::DidChange(const FlyString& file_uri, FileVersion version, FlyByteString raw) -> bool {
   qcore_assert(m_impl != nullptr);
+  NO3_TRACE_SPAN("lsp.fs", "FileBrowser::DidChange");
   std::lock_guard lock(m_impl->m_mutex);
 
   Log << Trace << "FileBrowser::DidChange(" << file_uri << ", " << version << ", " << raw->size() << " bytes)";
@@ -116,6 +107,7 @@ auto FileBrowser::DidChange(const FlyString& file_uri, FileVersion version, FlyB
 
 auto FileBrowser::DidChanges(const FlyString& file_uri, FileVersion version, IncrementalChanges changes) -> bool {
   qcore_assert(m_impl != nullptr);
+  NO3_TRACE_SPAN("lsp.fs", "FileBrowser::DidChanges");
   std::lock_guard lock(m_impl->m_mutex);
 
   Log << Trace << "FileBrowser::DidChange(" << file_uri << ", " << version << ", " << changes.size() << " changes)";
@@ -126,20 +118,28 @@ auto FileBrowser::DidChanges(const FlyString& file_uri, FileVersion version, Inc
     return false;
   }
 
-  std::basic_string<uint8_t> state = it->second->ReadAll();
+  // Each change shares all untouched structure with the previous version
+  Rope state = it->second->GetContent();
+  const auto encoding = GetPositionEncoding();
 
   for (size_t i = 0; i < changes.size(); ++i) {
     const auto& [range, new_content] = changes[i];
-    auto [start_line, start_character] = range.m_start;
-    auto [end_line_ex, end_character_ex] = range.m_end;
+    if (!range.has_value()) {
+      Log << Trace << "FileBrowser::DidChange: Change #" << i << " replaces the whole document";
+      state = Rope(new_content);
+      continue;
+    }
+
+    auto [start_line, start_character] = range->m_start;
+    auto [end_line_ex, end_character_ex] = range->m_end;
 
-    const auto start_offset = ConstFile::GetOffset(state, start_line, start_character);
+    const auto start_offset = ConstFile::GetOffset(state, start_line, start_character, encoding);
     if (!start_offset) {
       Log << "FileBrowser::DidChange: Failed to convert start line/column to offset";
       return false;
     }
 
-    const auto end_offset_plus_one = ConstFile::GetOffset(state, end_line_ex, end_character_ex);
+    const auto end_offset_plus_one = ConstFile::GetOffset(state, end_line_ex, end_character_ex, encoding);
     if (!end_offset_plus_one) {
       Log << "FileBrowser::DidChange: Failed to convert end line/column to offset";
       return false;
@@ -150,22 +150,22 @@ auto FileBrowser::DidChanges(const FlyString& file_uri, FileVersion version, Inc
         << ", o:" << *end_offset_plus_one << ")";
 
     const auto n = *end_offset_plus_one - *start_offset;
-    if (*start_offset > state.size()) {
-      Log << "FileBrowser::DidChange: Start offset is out of bounds: " << *start_offset << " > " << state.size();
+    if (*start_offset > state.Size()) {
+      Log << "FileBrowser::DidChange: Start offset is out of bounds: " << *start_offset << " > " << state.Size();
       return false;
     }
 
-    if (n > state.size()) {
-      Log << "FileBrowser::DidChange: End offset is out of bounds: " << n << " > " << state.size();
+    if (n > state.Size() - *start_offset) {
+      Log << "FileBrowser::DidChange: End offset is out of bounds: " << n << " > " << state.Size();
       return false;
     }
 
-    state.replace(*start_offset, n, *new_content);
+    state = state.Replace(*start_offset, n, new_content);
     Log << Trace << "FileBrowser::DidChange: Change #" << i << " applied to temporary state";
   }
 
   Log << Trace << "FileBrowser::DidChange: Flushing " << changes.size() << " changes to file: " << file_uri;
-  it->second = std::make_shared<ConstFile>(file_uri, version, FlyByteString(state));
+  it->second = std::make_shared<ConstFile>(file_uri, version, std::move(state));
   Log << Trace << "FileBrowser::DidChange: File changed: " << file_uri << " to version " << version;
 
   return true;
@@ -173,6 +173,7 @@ auto FileBrowser::DidChanges(const FlyString& file_uri, FileVersion version, Inc
 
 auto FileBrowser::DidSave(const FlyString& file_uri, std::optional<FlyByteString> full_content) -> bool {
   qcore_assert(m_impl != nullptr);
+  NO3_TRACE_SPAN("lsp.fs", "FileBrowser::DidSave");
   std::lock_guard lock(m_impl->m_mutex);
 
   Log << Trace << "FileBrowser::DidSave(" << file_uri << ")";
@@ -194,6 +195,7 @@ auto FileBrowser::DidSave(const FlyString& file_uri, std::optional<FlyByteString
 
 auto FileBrowser::DidClose(const FlyString& file_uri) -> bool {
   qcore_assert(m_impl != nullptr);
+  NO3_TRACE_SPAN("lsp.fs", "FileBrowser::DidClose");
   std::lock_guard lock(m_impl->m_mutex);
 
   Log << Trace << "FileBrowser::DidClose(" << file_uri << ")";
@@ -225,3 +227,13 @@ auto FileBrowser::GetFile(const FlyString& file_uri) const -> std::optional<Read
 
   return it->second;
 }
+
+void FileBrowser::SetPositionEncoding(protocol::PositionEncoding encoding) {
+  qcore_assert(m_impl != nullptr);
+  m_impl->m_encoding.store(encoding, std::memory_order_relaxed);
+}
+
+auto FileBrowser::GetPositionEncoding() const -> protocol::PositionEncoding {
+  qcore_assert(m_impl != nullptr);
+  return m_impl->m_encoding.load(std::memory_order_relaxed);
+}
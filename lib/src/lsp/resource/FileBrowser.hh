@@ -51,6 +51,7 @@ namespace no3::lsp::core {
     FileBrowser& operator=(FileBrowser&&) = default;
     ~FileBrowser();
 
+    /// Applied in order to one working copy; a single new version is published only if all of them apply.
     using IncrementalChanges = std::span<const protocol::TextDocumentContentChangeEvent>;
     using ReadOnlyFile = std::shared_ptr<ConstFile>;
 
@@ -61,5 +62,9 @@ namespace no3::lsp::core {
                                std::optional<FlyByteString> full_content = std::nullopt) -> bool;
     [[nodiscard]] auto DidClose(const FlyString& file_uri) -> bool;
     [[nodiscard]] auto GetFile(const FlyString& file_uri) const -> std::optional<ReadOnlyFile>;
+
+    /// How incoming change ranges count columns. UTF-16 until `initialize` negotiates otherwise.
+    void SetPositionEncoding(protocol::PositionEncoding encoding);
+    [[nodiscard]] auto GetPositionEncoding() const -> protocol::PositionEncoding;
   };
 }  // namespace no3::lsp::core
@@ -0,0 +1,311 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <algorithm>
+#include <lsp/resource/Rope.hh>
+#include <lsp/resource/TextKernels.hh>
+#include <nitrate-core/Assert.hh>
+
+using namespace no3::lsp::core;
+
+static auto GetHeightOf(const auto& node) -> int { return node == nullptr ? -1 : node->m_height; }
+
+auto Rope::MakeLeaf(BytesView text) -> NodePtr {
+  auto leaf = std::make_shared<Node>();
+  leaf->m_text = Bytes(text);
+  leaf->m_size = text.size();
+  leaf->m_breaks = CountLeafBreaks(text);
+
+  if (!text.empty()) {
+    leaf->m_first = text.front();
+    leaf->m_last = text.back();
+  }
+
+  return leaf;
+}
+
+auto Rope::MakeBranch(NodePtr left, NodePtr right) -> NodePtr {
+  auto branch = std::make_shared<Node>();
+  branch->m_size = left->m_size + right->m_size;
+  branch->m_height = std::max(left->m_height, right->m_height) + 1;
+  branch->m_first = left->m_first;
+  branch->m_last = right->m_last;
+  branch->m_left = std::move(left);
+  branch->m_right = std::move(right);
+  branch->m_breaks = branch->m_left->m_breaks + branch->m_right->m_breaks - (HasSplitCRLF(*branch) ? 1 : 0);
+
+  return branch;
+}
+
+auto Rope::Rebalance(NodePtr left, NodePtr right) -> NodePtr {
+  const auto lh = GetHeightOf(left);
+  const auto rh = GetHeightOf(right);
+
+  if (lh > rh + 1) {
+    if (GetHeightOf(left->m_left) >= GetHeightOf(left->m_right)) {
+      return MakeBranch(left->m_left, MakeBranch(left->m_right, std::move(right)));
+    }
+
+    const auto& pivot = left->m_right;
+    return MakeBranch(MakeBranch(left->m_left, pivot->m_left), MakeBranch(pivot->m_right, std::move(right)));
+  }
+
+  if (rh > lh + 1) {
+    if (GetHeightOf(right->m_right) >= GetHeightOf(right->m_left)) {
+      return MakeBranch(MakeBranch(std::move(left), right->m_left), right->m_right);
+    }
+
+    const auto& pivot = right->m_left;
+    return MakeBranch(MakeBranch(std::move(left), pivot->m_left), MakeBranch(pivot->m_right, right->m_right));
+  }
+
+  return MakeBranch(std::move(left), std::move(right));
+}
+
+auto Rope::Join(NodePtr left, NodePtr right) -> NodePtr {
+  if (left == nullptr || left->m_size == 0) {
+    return right;
+  }
+
+  if (right == nullptr || right->m_size == 0) {
+    return left;
+  }
+
+  if (left->IsLeaf() && right->IsLeaf()) {
+    if (left->m_size + right->m_size <= kMaxLeafSize) {
+      return MakeLeaf(left->m_text + right->m_text);
+    }
+
+    return MakeBranch(std::move(left), std::move(right));
+  }
+
+  // Descend the taller side's inner spine until the heights meet, then rebalance on the way back up
+  if (left->m_height > right->m_height) {
+    return Rebalance(left->m_left, Join(left->m_right, std::move(right)));
+  }
+
+  if (right->m_height > left->m_height) {
+    return Rebalance(Join(std::move(left), right->m_left), right->m_right);
+  }
+
+  return MakeBranch(std::move(left), std::move(right));
+}
+
+auto Rope::Split(const NodePtr& node, size_t offset) -> std::pair<NodePtr, NodePtr> {
+  if (node == nullptr) {
+    return {nullptr, nullptr};
+  }
+
+  if (offset == 0) {
+    return {nullptr, node};
+  }
+
+  if (offset >= node->m_size) {
+    return {node, nullptr};
+  }
+
+  if (node->IsLeaf()) {
+    const auto text = BytesView(node->m_text);
+    return {MakeLeaf(text.substr(0, offset)), MakeLeaf(text.substr(offset))};
+  }
+
+  const auto left_size = node->m_left->m_size;
+  if (offset < left_size) {
+    auto [left, right] = Split(node->m_left, offset);
+    return {std::move(left), Join(std::move(right), node->m_right)};
+  }
+
+  auto [left, right] = Split(node->m_right, offset - left_size);
+  return {Join(node->m_left, std::move(left)), std::move(right)};
+}
+
+auto Rope::Build(BytesView text) -> NodePtr {
+  if (text.empty()) {
+    return nullptr;
+  }
+
+  if (text.size() <= kMaxLeafSize) {
+    return MakeLeaf(text);
+  }
+
+  // Split on a leaf multiple so that every leaf but the last is full
+  const auto leaves = (text.size() + kMaxLeafSize - 1) / kMaxLeafSize;
+  const auto mid = (leaves / 2) * kMaxLeafSize;
+
+  return MakeBranch(Build(text.substr(0, mid)), Build(text.substr(mid)));
+}
+
+auto Rope::GetLeafBounds(const NodePtr& node, size_t offset) -> std::pair<size_t, size_t> {
+  size_t base = 0;
+  const Node* current = node.get();
+
+  while (current != nullptr && !current->IsLeaf()) {
+    const auto left_size = current->m_left->m_size;
+    if (offset < left_size) {
+      current = current->m_left.get();
+    } else {
+      base += left_size;
+      offset -= left_size;
+      current = current->m_right.get();
+    }
+  }
+
+  return {base, base + (current == nullptr ? 0 : current->m_size)};
+}
+
+auto Rope::CountLeafBreaks(BytesView text) -> size_t { return text::CountLineBreaks(text); }
+
+/// A CRLF pair straddling the two children is counted once by each of them.
+auto Rope::HasSplitCRLF(const Node& branch) -> bool {
+  return branch.m_left->m_last == '\r' && branch.m_right->m_first == '\n';
+}
+
+Rope::Rope(BytesView text) : m_root(Build(text)) {}
+
+auto Rope::Size() const -> size_t { return m_root == nullptr ? 0 : m_root->m_size; }
+
+auto Rope::GetHeight() const -> size_t { return m_root == nullptr ? 0 : m_root->m_height + 1; }
+
+auto Rope::GetLineCount() const -> size_t { return (m_root == nullptr ? 0 : m_root->m_breaks) + 1; }
+
+auto Rope::GetLineStart(size_t line) const -> std::optional<size_t> {
+  if (line == 0) {
+    return 0;
+  }
+
+  if (line >= GetLineCount()) {
+    return std::nullopt;
+  }
+
+  // Find where the line-th break ends
+  size_t base = 0;
+  size_t target = line;
+  const Node* node = m_root.get();
+
+  while (!node->IsLeaf()) {
+    const auto split_crlf = HasSplitCRLF(*node);
+    const auto left_breaks = node->m_left->m_breaks;
+
+    if (target < left_breaks || (target == left_breaks && !split_crlf)) {
+      node = node->m_left.get();
+      continue;
+    }
+
+    if (target == left_breaks) {
+      // The break is the CR ending the left side; the line starts after the LF that opens the right side
+      return base + node->m_left->m_size + 1;
+    }
+
+    base += node->m_left->m_size;
+    target = target - left_breaks + (split_crlf ? 1 : 0);
+    node = node->m_right.get();
+  }
+
+  const auto text = BytesView(node->m_text);
+  for (size_t i = text::FindLineBreak(text); i < text.size(); i += text::FindLineBreak(text.substr(i))) {
+    const auto is_crlf = text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n';
+    i += is_crlf ? 2 : 1;
+
+    if (--target == 0) {
+      return base + i;
+    }
+  }
+
+  qcore_panic("Rope line break counts are inconsistent");
+}
+
+auto Rope::CountLineBreaks(size_t offset) const -> size_t {
+  size_t breaks = 0;
+  const Node* node = m_root.get();
+  offset = std::min(offset, Size());
+
+  while (node != nullptr && offset != 0 && !node->IsLeaf()) {
+    const auto left_size = node->m_left->m_size;
+    if (offset <= left_size) {
+      node = node->m_left.get();
+      continue;
+    }
+
+    // The right side's prefix is non-empty, so it includes its half of a straddling CRLF
+    breaks += node->m_left->m_breaks - (HasSplitCRLF(*node) ? 1 : 0);
+    offset -= left_size;
+    node = node->m_right.get();
+  }
+
+  if (node != nullptr && offset != 0) {
+    breaks += CountLeafBreaks(BytesView(node->m_text).substr(0, offset));
+  }
+
+  return breaks;
+}
+
+auto Rope::Replace(size_t offset, size_t count, BytesView text) const -> Rope {
+  qcore_assert(offset <= Size() && count <= Size() - offset);
+
+  // Cut on leaf boundaries so no sliver leaves are left behind; the touched leaves are rebuilt with the edit
+  const auto end = offset + count;
+  const auto cut_begin = GetLeafBounds(m_root, offset).first;
+  const auto cut_end = end == 0 ? 0 : std::max(GetLeafBounds(m_root, end - 1).second, end);
+
+  Bytes middle;
+  middle.reserve((offset - cut_begin) + text.size() + (cut_end - end));
+  ForEachChunk(cut_begin, offset - cut_begin, [&](BytesView chunk) {
+    middle += chunk;
+    return true;
+  });
+  middle += text;
+  ForEachChunk(end, cut_end - end, [&](BytesView chunk) {
+    middle += chunk;
+    return true;
+  });
+
+  auto [head, rest] = Split(m_root, cut_begin);
+  auto [_, tail] = Split(rest, cut_end - cut_begin);
+
+  return Rope(Join(Join(std::move(head), Build(middle)), std::move(tail)));
+}
+
+auto Rope::Substr(size_t offset, size_t count) const -> Bytes {
+  qcore_assert(offset <= Size());
+  count = std::min(count, Size() - offset);
+
+  Bytes result;
+  result.reserve(count);
+  ForEachChunk(offset, count, [&](BytesView chunk) {
+    result += chunk;
+    return true;
+  });
+
+  return result;
+}
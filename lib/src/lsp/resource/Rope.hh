@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Immutable byte rope with structural sharing between versions.
+   *
+   * The text is held in leaves of at most `kMaxLeafSize` bytes under an AVL
+   * tree of shared, never-mutated nodes. `Replace()` returns a new rope that
+   * shares every untouched subtree with the old one, so an edit costs
+   * O(log n + edit size) time and memory regardless of document size, and old
+   * versions stay valid for as long as someone holds them.
+   *
+   * Every node also counts the line breaks beneath it (`\n`, `\r\n` and lone
+   * `\r`, as LSP defines them), so mapping between lines and byte offsets is a
+   * descent of the tree rather than a scan of the document.
+   */
+  class Rope final {
+  public:
+    using Bytes = std::basic_string<uint8_t>;
+    using BytesView = std::basic_string_view<uint8_t>;
+
+    static constexpr size_t kMaxLeafSize = 1024;
+
+  private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    NodePtr m_root;
+
+    explicit Rope(NodePtr root) : m_root(std::move(root)) {}
+
+    static auto MakeLeaf(BytesView text) -> NodePtr;
+    static auto MakeBranch(NodePtr left, NodePtr right) -> NodePtr;
+    static auto Rebalance(NodePtr left, NodePtr right) -> NodePtr;
+    static auto Join(NodePtr left, NodePtr right) -> NodePtr;
+    static auto Split(const NodePtr& node, size_t offset) -> std::pair<NodePtr, NodePtr>;
+    static auto Build(BytesView text) -> NodePtr;
+    static auto GetLeafBounds(const NodePtr& node, size_t offset) -> std::pair<size_t, size_t>;
+    static auto CountLeafBreaks(BytesView text) -> size_t;
+    static auto HasSplitCRLF(const Node& branch) -> bool;
+
+    template <typename Callback>
+    static auto VisitChunks(const Node* node, size_t offset, size_t count, Callback& callback) -> bool;
+
+  public:
+    Rope() = default;
+    explicit Rope(BytesView text);
+
+    [[nodiscard]] auto Size() const -> size_t;
+    [[nodiscard]] auto Empty() const -> bool { return Size() == 0; }
+    [[nodiscard]] auto GetHeight() const -> size_t;
+    [[nodiscard]] auto GetLineCount() const -> size_t;
+
+    /// Offset of the first byte of `line` (zero-based), or nothing if the rope has fewer lines.
+    [[nodiscard]] auto GetLineStart(size_t line) const -> std::optional<size_t>;
+
+    /// Number of line breaks that end within [0, offset).
+    [[nodiscard]] auto CountLineBreaks(size_t offset) const -> size_t;
+
+    /// Replace `count` bytes at `offset` with `text`. Both must lie within the rope.
+    [[nodiscard]] auto Replace(size_t offset, size_t count, BytesView text) const -> Rope;
+
+    [[nodiscard]] auto Substr(size_t offset, size_t count) const -> Bytes;
+    [[nodiscard]] auto ToBytes() const -> Bytes { return Substr(0, Size()); }
+
+    /// Call `callback(BytesView)` for each contiguous piece of [offset, offset + count), in order.
+    /// Stops early if the callback returns false.
+    template <typename Callback>
+    auto ForEachChunk(size_t offset, size_t count, Callback callback) const -> bool {
+      return VisitChunks(m_root.get(), offset, count, callback);
+    }
+
+    template <typename Callback>
+    auto ForEachChunk(Callback callback) const -> bool {
+      return ForEachChunk(0, Size(), std::move(callback));
+    }
+  };
+
+  struct Rope::Node {
+    NodePtr m_left;
+    NodePtr m_right;
+    Bytes m_text;
+    size_t m_size = 0;
+    size_t m_breaks = 0;
+    uint8_t m_first = 0;
+    uint8_t m_last = 0;
+    uint8_t m_height = 0;
+
+    [[nodiscard]] auto IsLeaf() const -> bool { return m_left == nullptr; }
+  };
+
+  template <typename Callback>
+  auto Rope::VisitChunks(const Node* node, size_t offset, size_t count, Callback& callback) -> bool {
+    while (node != nullptr && count != 0) {
+      if (node->IsLeaf()) {
+        return callback(BytesView(node->m_text).substr(offset, count));
+      }
+
+      const auto left_size = node->m_left->m_size;
+      if (offset >= left_size) {
+        offset -= left_size;
+        node = node->m_right.get();
+        continue;
+      }
+
+      const auto left_count = std::min(count, left_size - offset);
+      if (!VisitChunks(node->m_left.get(), offset, left_count, callback)) {
+        return false;
+      }
+
+      offset = 0;
+      count -= left_count;
+      node = node->m_right.get();
+    }
+
+    return true;
+  }
+}  // namespace no3::lsp::core
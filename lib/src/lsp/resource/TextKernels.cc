@@ -0,0 +1,477 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <lsp/resource/TextKernels.hh>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace no3::lsp::core;
+using namespace no3::lsp::core::text;
+
+namespace {
+  struct Kernels {
+    size_t (*m_find_line_break)(BytesView);
+    size_t (*m_count_line_breaks)(BytesView);
+    size_t (*m_count_utf16_units)(BytesView);
+    size_t (*m_find_utf16_column)(BytesView, uint64_t);
+  };
+
+  constexpr auto IsContinuation(uint8_t byte) -> bool { return (byte & 0xC0) == 0x80; }
+
+  /// F0..F4 lead a supplementary-plane code point (a surrogate pair); F5..FF never lead anything.
+  constexpr auto GetUTF16Units(uint8_t byte) -> uint64_t {
+    if (IsContinuation(byte) || byte >= 0xF5) {
+      return 0;
+    }
+
+    return byte >= 0xF0 ? 2 : 1;
+  }
+
+  ///==========================================================================
+  /// Scalar
+
+  auto FindLineBreakScalar(BytesView text) -> size_t {
+    for (size_t i = 0; i < text.size(); ++i) {
+      if (text[i] == '\n' || text[i] == '\r') {
+        return i;
+      }
+    }
+
+    return text.size();
+  }
+
+  auto CountLineBreaksScalar(BytesView text) -> size_t {
+    size_t breaks = 0;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+      const auto ch = text[i];
+      breaks += static_cast<size_t>(ch == '\n' || ch == '\r');
+      breaks -= static_cast<size_t>(ch == '\r' && i + 1 < text.size() && text[i + 1] == '\n');
+    }
+
+    return breaks;
+  }
+
+  auto CountUTF16UnitsScalar(BytesView utf8) -> size_t {
+    size_t units = 0;
+    for (const auto byte : utf8) {
+      units += GetUTF16Units(byte);
+    }
+
+    return units;
+  }
+
+  auto FindUTF16ColumnFrom(BytesView line, size_t i, uint64_t remaining) -> size_t {
+    for (; i < line.size(); ++i) {
+      const auto byte = line[i];
+      if (IsContinuation(byte)) {
+        continue;
+      }
+
+      if (remaining == 0) {
+        return i;
+      }
+
+      const auto units = GetUTF16Units(byte);
+      if (units > remaining) {
+        return line.size();
+      }
+
+      remaining -= units;
+    }
+
+    return line.size();
+  }
+
+  auto FindUTF16ColumnScalar(BytesView line, uint64_t column) -> size_t { return FindUTF16ColumnFrom(line, 0, column); }
+
+  constexpr Kernels kScalarKernels = {
+      .m_find_line_break = FindLineBreakScalar,
+      .m_count_line_breaks = CountLineBreaksScalar,
+      .m_count_utf16_units = CountUTF16UnitsScalar,
+      .m_find_utf16_column = FindUTF16ColumnScalar,
+  };
+
+#if defined(__x86_64__)
+  ///==========================================================================
+  /// SSE2 (always available on x86-64)
+
+  /// -1 in each lane where the byte adds a UTF-16 unit, and again where it adds a second; +1 where it takes one back.
+  inline auto GetUTF16UnitMasksSSE2(__m128i v, __m128i& leads, __m128i& pairs, __m128i& invalid) {
+    leads = _mm_cmpgt_epi8(v, _mm_set1_epi8(-65));  // Not 0x80..0xBF
+    pairs = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(-17)), _mm_cmplt_epi8(v, _mm_set1_epi8(-11)));
+    invalid = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(-12)), _mm_cmplt_epi8(v, _mm_setzero_si128()));
+  }
+
+  inline auto SumBytesSSE2(__m128i v) -> size_t {
+    const auto sums = _mm_sad_epu8(v, _mm_setzero_si128());
+    return _mm_cvtsi128_si64(sums) + _mm_extract_epi16(sums, 4);
+  }
+
+  auto FindLineBreakSSE2(BytesView text) -> size_t {
+    const auto lf = _mm_set1_epi8('\n');
+    const auto cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+
+    for (; i + 16 <= text.size(); i += 16) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+      const auto mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+      if (mask != 0) {
+        return i + std::countr_zero(static_cast<uint32_t>(mask));
+      }
+    }
+
+    return i + FindLineBreakScalar(text.substr(i));
+  }
+
+  auto CountLineBreaksSSE2(BytesView text) -> size_t {
+    const auto lf = _mm_set1_epi8('\n');
+    const auto cr = _mm_set1_epi8('\r');
+    size_t breaks = 0;
+    size_t i = 0;
+
+    // One byte of lookahead finds the CRLF pairs; each lane gains at most 1 per block
+    while (i + 17 <= text.size()) {
+      auto acc = _mm_setzero_si128();
+      for (size_t blocks = 0; blocks < 255 && i + 17 <= text.size(); ++blocks, i += 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        const auto next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + 1));
+        const auto is_cr = _mm_cmpeq_epi8(v, cr);
+        const auto is_crlf = _mm_and_si128(is_cr, _mm_cmpeq_epi8(next, lf));
+        acc = _mm_add_epi8(_mm_sub_epi8(acc, _mm_or_si128(_mm_cmpeq_epi8(v, lf), is_cr)), is_crlf);
+      }
+
+      breaks += SumBytesSSE2(acc);
+    }
+
+    return breaks + CountLineBreaksScalar(text.substr(i));
+  }
+
+  auto CountUTF16UnitsSSE2(BytesView utf8) -> size_t {
+    size_t units = 0;
+    size_t i = 0;
+
+    while (i + 16 <= utf8.size()) {
+      // Each lane gains at most 2 per block, so 127 blocks fit in a byte
+      auto acc = _mm_setzero_si128();
+      for (size_t blocks = 0; blocks < 127 && i + 16 <= utf8.size(); ++blocks, i += 16) {
+        __m128i leads;
+        __m128i pairs;
+        __m128i invalid;
+        GetUTF16UnitMasksSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8.data() + i)), leads, pairs,
+                              invalid);
+        acc = _mm_add_epi8(_mm_sub_epi8(_mm_sub_epi8(acc, leads), pairs), invalid);
+      }
+
+      units += SumBytesSSE2(acc);
+    }
+
+    return units + CountUTF16UnitsScalar(utf8.substr(i));
+  }
+
+  auto FindUTF16ColumnSSE2(BytesView line, uint64_t column) -> size_t {
+    size_t i = 0;
+
+    for (; i + 16 <= line.size(); i += 16) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line.data() + i));
+
+      size_t block_units = 16;
+      if (_mm_movemask_epi8(v) != 0) {
+        __m128i leads;
+        __m128i pairs;
+        __m128i invalid;
+        GetUTF16UnitMasksSSE2(v, leads, pairs, invalid);
+        block_units = SumBytesSSE2(_mm_add_epi8(_mm_sub_epi8(_mm_sub_epi8(_mm_setzero_si128(), leads), pairs), invalid));
+      }
+
+      // Skip only blocks that end strictly before the column; the scalar tail finds the exact byte
+      if (block_units >= column) {
+        break;
+      }
+
+      column -= block_units;
+    }
+
+    return FindUTF16ColumnFrom(line, i, column);
+  }
+
+  constexpr Kernels kSSE2Kernels = {
+      .m_find_line_break = FindLineBreakSSE2,
+      .m_count_line_breaks = CountLineBreaksSSE2,
+      .m_count_utf16_units = CountUTF16UnitsSSE2,
+      .m_find_utf16_column = FindUTF16ColumnSSE2,
+  };
+
+  ///==========================================================================
+  /// AVX2
+
+#define NO3_TARGET_AVX2 __attribute__((target("avx2,bmi")))
+
+  NO3_TARGET_AVX2 inline auto GetUTF16UnitMasksAVX2(__m256i v, __m256i& leads, __m256i& pairs, __m256i& invalid) {
+    leads = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(-65));
+    pairs = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(-17)), _mm256_cmpgt_epi8(_mm256_set1_epi8(-11), v));
+    invalid = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(-12)), _mm256_cmpgt_epi8(_mm256_setzero_si256(), v));
+  }
+
+  NO3_TARGET_AVX2 inline auto SumBytesAVX2(__m256i v) -> size_t {
+    const auto sums = _mm256_sad_epu8(v, _mm256_setzero_si256());
+    return _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) + _mm256_extract_epi64(sums, 2) +
+           _mm256_extract_epi64(sums, 3);
+  }
+
+  NO3_TARGET_AVX2 auto FindLineBreakAVX2(BytesView text) -> size_t {
+    const auto lf = _mm256_set1_epi8('\n');
+    const auto cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+
+    for (; i + 32 <= text.size(); i += 32) {
+      const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+      const auto mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+      if (mask != 0) {
+        return i + std::countr_zero(static_cast<uint32_t>(mask));
+      }
+    }
+
+    return i + FindLineBreakSSE2(text.substr(i));
+  }
+
+  NO3_TARGET_AVX2 auto CountLineBreaksAVX2(BytesView text) -> size_t {
+    const auto lf = _mm256_set1_epi8('\n');
+    const auto cr = _mm256_set1_epi8('\r');
+    size_t breaks = 0;
+    size_t i = 0;
+
+    while (i + 33 <= text.size()) {
+      auto acc = _mm256_setzero_si256();
+      for (size_t blocks = 0; blocks < 255 && i + 33 <= text.size(); ++blocks, i += 32) {
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+        const auto next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + 1));
+        const auto is_cr = _mm256_cmpeq_epi8(v, cr);
+        const auto is_crlf = _mm256_and_si256(is_cr, _mm256_cmpeq_epi8(next, lf));
+        acc = _mm256_add_epi8(_mm256_sub_epi8(acc, _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), is_cr)), is_crlf);
+      }
+
+      breaks += SumBytesAVX2(acc);
+    }
+
+    return breaks + CountLineBreaksSSE2(text.substr(i));
+  }
+
+  NO3_TARGET_AVX2 auto CountUTF16UnitsAVX2(BytesView utf8) -> size_t {
+    size_t units = 0;
+    size_t i = 0;
+
+    while (i + 32 <= utf8.size()) {
+      auto acc = _mm256_setzero_si256();
+      for (size_t blocks = 0; blocks < 127 && i + 32 <= utf8.size(); ++blocks, i += 32) {
+        __m256i leads;
+        __m256i pairs;
+        __m256i invalid;
+        GetUTF16UnitMasksAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8.data() + i)), leads, pairs,
+                              invalid);
+        acc = _mm256_add_epi8(_mm256_sub_epi8(_mm256_sub_epi8(acc, leads), pairs), invalid);
+      }
+
+      units += SumBytesAVX2(acc);
+    }
+
+    return units + CountUTF16UnitsSSE2(utf8.substr(i));
+  }
+
+  NO3_TARGET_AVX2 auto FindUTF16ColumnAVX2(BytesView line, uint64_t column) -> size_t {
+    size_t i = 0;
+
+    for (; i + 32 <= line.size(); i += 32) {
+      const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line.data() + i));
+
+      size_t block_units = 32;
+      if (_mm256_movemask_epi8(v) != 0) {
+        __m256i leads;
+        __m256i pairs;
+        __m256i invalid;
+        GetUTF16UnitMasksAVX2(v, leads, pairs, invalid);
+        block_units = SumBytesAVX2(
+            _mm256_add_epi8(_mm256_sub_epi8(_mm256_sub_epi8(_mm256_setzero_si256(), leads), pairs), invalid));
+      }
+
+      if (block_units >= column) {
+        break;
+      }
+
+      column -= block_units;
+    }
+
+    return FindUTF16ColumnFrom(line, i, column);
+  }
+
+#undef NO3_TARGET_AVX2
+
+  constexpr Kernels kAVX2Kernels = {
+      .m_find_line_break = FindLineBreakAVX2,
+      .m_count_line_breaks = CountLineBreaksAVX2,
+      .m_count_utf16_units = CountUTF16UnitsAVX2,
+      .m_find_utf16_column = FindUTF16ColumnAVX2,
+  };
+#endif
+
+  auto IsSupported(ISA isa) -> bool {
+    switch (isa) {
+      case ISA::Scalar:
+        return true;
+#if defined(__x86_64__)
+      case ISA::SSE2:
+        return true;
+      case ISA::AVX2:
+        // Detection may run from a static initialiser, before libgcc has filled in the CPU model
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+#else
+      case ISA::SSE2:
+      case ISA::AVX2:
+        return false;
+#endif
+    }
+
+    return false;
+  }
+
+  auto GetKernels(ISA isa) -> const Kernels* {
+    switch (isa) {
+#if defined(__x86_64__)
+      case ISA::AVX2:
+        return &kAVX2Kernels;
+      case ISA::SSE2:
+        return &kSSE2Kernels;
+#endif
+      default:
+        return &kScalarKernels;
+    }
+  }
+
+  auto DetectISA() -> ISA {
+    for (auto isa : {ISA::AVX2, ISA::SSE2}) {
+      if (IsSupported(isa)) {
+        return isa;
+      }
+    }
+
+    return ISA::Scalar;
+  }
+
+  // Constant-initialised so kernels are usable from other static initialisers
+  std::atomic<ISA> CurrentISA = ISA::Scalar;
+  std::atomic<const Kernels*> CurrentKernels = nullptr;
+
+  auto GetCurrentKernels() -> const Kernels* {
+    if (const auto* kernels = CurrentKernels.load(std::memory_order_relaxed)) [[likely]] {
+      return kernels;
+    }
+
+    const auto isa = DetectISA();
+    CurrentISA.store(isa, std::memory_order_relaxed);
+    CurrentKernels.store(GetKernels(isa), std::memory_order_relaxed);
+
+    return GetKernels(isa);
+  }
+}  // namespace
+
+auto text::FindLineBreak(BytesView text) -> size_t {
+  return GetCurrentKernels()->m_find_line_break(text);
+}
+
+auto text::CountLineBreaks(BytesView text) -> size_t {
+  return GetCurrentKernels()->m_count_line_breaks(text);
+}
+
+void text::NormalizeToLF(BytesView text, Bytes& out) {
+  out.reserve(out.size() + text.size());
+
+  // memchr is already vectorised by libc; runs without a CR are copied in bulk
+  while (!text.empty()) {
+    const auto* cr = static_cast<const uint8_t*>(std::memchr(text.data(), '\r', text.size()));
+    if (cr == nullptr) {
+      out += text;
+      break;
+    }
+
+    const auto run = static_cast<size_t>(cr - text.data());
+    out += text.substr(0, run);
+    out += '\n';
+
+    const auto is_crlf = run + 1 < text.size() && text[run + 1] == '\n';
+    text.remove_prefix(run + (is_crlf ? 2 : 1));
+  }
+}
+
+auto text::CountUTF16Units(BytesView utf8) -> size_t {
+  return GetCurrentKernels()->m_count_utf16_units(utf8);
+}
+
+auto text::FindUTF16Column(BytesView line, uint64_t column) -> size_t {
+  return GetCurrentKernels()->m_find_utf16_column(line, column);
+}
+
+auto text::GetISA() -> ISA {
+  GetCurrentKernels();
+  return CurrentISA.load(std::memory_order_relaxed);
+}
+
+auto text::GetISAName(ISA isa) -> std::string_view {
+  switch (isa) {
+    case ISA::Scalar:
+      return "scalar";
+    case ISA::SSE2:
+      return "sse2";
+    case ISA::AVX2:
+      return "avx2";
+  }
+
+  return "unknown";
+}
+
+auto text::SetISA(ISA isa) -> bool {
+  if (!IsSupported(isa)) {
+    return false;
+  }
+
+  CurrentKernels.store(GetKernels(isa), std::memory_order_relaxed);
+  CurrentISA.store(isa, std::memory_order_relaxed);
+
+  return true;
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Vectorised byte kernels for document text.
+ *
+ * Each kernel has a scalar, an SSE2 and an AVX2 implementation; the widest one
+ * the CPU supports is picked on first use. All implementations return
+ * identical results for any input, including malformed UTF-8.
+ */
+namespace no3::lsp::core::text {
+  using Bytes = std::basic_string<uint8_t>;
+  using BytesView = std::basic_string_view<uint8_t>;
+
+  enum class ISA : uint8_t { Scalar, SSE2, AVX2 };
+
+  /// Offset of the first `\r` or `\n`, or `text.size()`.
+  [[nodiscard]] auto FindLineBreak(BytesView text) -> size_t;
+
+  /// Line breaks as LSP counts them: `\n`, `\r\n` and lone `\r`.
+  [[nodiscard]] auto CountLineBreaks(BytesView text) -> size_t;
+
+  /// Append `text` to `out` with every `\r\n` and lone `\r` replaced by `\n`.
+  void NormalizeToLF(BytesView text, Bytes& out);
+
+  /// UTF-16 code units needed for `utf8`. Continuation bytes and bytes that cannot start a sequence count zero.
+  [[nodiscard]] auto CountUTF16Units(BytesView utf8) -> size_t;
+
+  /// Byte offset of the code point at UTF-16 `column` in `line`. Returns `line.size()` if the line is shorter,
+  /// or if the column falls inside a surrogate pair.
+  [[nodiscard]] auto FindUTF16Column(BytesView line, uint64_t column) -> size_t;
+
+  [[nodiscard]] auto GetISA() -> ISA;
+  [[nodiscard]] auto GetISAName(ISA isa) -> std::string_view;
+
+  /// For benchmarks: use `isa` from now on. Fails if the CPU lacks it.
+  auto SetISA(ISA isa) -> bool;
+}  // namespace no3::lsp::core::text
@@ -0,0 +1,379 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <libdeflate.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <lsp/server/AsyncFileLogger.hh>
+
+using namespace no3::lsp::core;
+
+static constexpr int kCompressionLevel = 6;
+static constexpr size_t kCompressionChunkSize = 128 * 1024;
+
+class AsyncFileLogger::ThreadBuffer final {
+  std::unique_ptr<char[]> m_data;
+  size_t m_mask;
+
+  alignas(64) std::atomic<size_t> m_head = 0;  // written by the owning thread
+  alignas(64) std::atomic<size_t> m_tail = 0;  // written by the flusher
+
+public:
+  std::atomic<uint64_t> m_dropped = 0;
+
+  ThreadBuffer(size_t capacity) : m_data(std::make_unique<char[]>(capacity)), m_mask(capacity - 1) {}
+
+  [[nodiscard]] auto Capacity() const -> size_t { return m_mask + 1; }
+
+  /// Returns the number of bytes in use after the push, or zero if the line was dropped.
+  auto Push(std::string_view line) -> size_t {
+    const auto record_size = line.size() + 1;
+    const auto head = m_head.load(std::memory_order_relaxed);
+    const auto used = head - m_tail.load(std::memory_order_acquire);
+
+    if (record_size > Capacity() - used) [[unlikely]] {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    }
+
+    const auto offset = head & m_mask;
+    const auto first = std::min(line.size(), Capacity() - offset);
+    std::memcpy(&m_data[offset], line.data(), first);
+    std::memcpy(&m_data[0], line.data() + first, line.size() - first);
+    m_data[(head + line.size()) & m_mask] = '\n';
+
+    m_head.store(head + record_size, std::memory_order_release);
+
+    return used + record_size;
+  }
+
+  void Drain(std::string& out) {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    const auto head = m_head.load(std::memory_order_acquire);
+    const auto size = head - tail;
+    if (size == 0) {
+      return;
+    }
+
+    const auto offset = tail & m_mask;
+    const auto first = std::min(size, Capacity() - offset);
+    out.append(&m_data[offset], first);
+    out.append(&m_data[0], size - first);
+
+    m_tail.store(head, std::memory_order_release);
+  }
+};
+
+/// Distinguishes loggers in the per-thread buffer cache, even if one is allocated at a previous one's address.
+static std::atomic<uint64_t> NEXT_LOGGER_ID = 1;
+
+struct CachedThreadBuffer {
+  uint64_t m_logger_id;
+  std::shared_ptr<void> m_buffer;
+};
+
+static thread_local std::vector<CachedThreadBuffer> THREAD_BUFFERS;
+
+AsyncFileLogger::AsyncFileLogger(std::filesystem::path path, Options options, int fd, size_t file_size)
+    : m_path(std::move(path)),
+      m_options(options),
+      m_fd(fd),
+      m_file_size(file_size),
+      m_id(NEXT_LOGGER_ID.fetch_add(1, std::memory_order_relaxed)) {
+  m_options.m_thread_buffer_size = std::bit_ceil(std::max<size_t>(m_options.m_thread_buffer_size, 4096));
+  m_flusher = std::jthread([this](const std::stop_token& st) { FlusherLoop(st); });
+}
+
+AsyncFileLogger::~AsyncFileLogger() {
+  m_flusher.request_stop();
+  if (m_flusher.joinable()) {
+    m_flusher.join();
+  }
+
+  if (m_fd != -1) {
+    ::close(m_fd);
+  }
+}
+
+auto AsyncFileLogger::Open(std::filesystem::path path, Options options) -> std::unique_ptr<AsyncFileLogger> {
+  const auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  return std::unique_ptr<AsyncFileLogger>(
+      new AsyncFileLogger(std::move(path), options, fd, static_cast<size_t>(st.st_size)));
+}
+
+auto AsyncFileLogger::GetThreadBuffer() -> ThreadBuffer& {
+  for (const auto& cached : THREAD_BUFFERS) {
+    if (cached.m_logger_id == m_id) [[likely]] {
+      return *static_cast<ThreadBuffer*>(cached.m_buffer.get());
+    }
+  }
+
+  auto buffer = std::make_shared<ThreadBuffer>(m_options.m_thread_buffer_size);
+
+  {
+    std::lock_guard lock(m_buffers_mutex);
+    m_buffers.push_back(buffer);
+  }
+
+  THREAD_BUFFERS.push_back({.m_logger_id = m_id, .m_buffer = buffer});
+
+  return *buffer;
+}
+
+void AsyncFileLogger::Write(std::string_view line) {
+  auto& buffer = GetThreadBuffer();
+
+  // Wake the flusher early instead of waiting for the interval once a ring is half full
+  if (buffer.Push(line) > buffer.Capacity() / 2) {
+    {
+      std::lock_guard lock(m_wakeup_mutex);
+      m_wake_requested = true;
+    }
+
+    m_wakeup.notify_one();
+  }
+}
+
+void AsyncFileLogger::FlusherLoop(const std::stop_token& st) {
+  std::string batch;
+
+  while (!st.stop_requested()) {
+    {
+      std::unique_lock lock(m_wakeup_mutex);
+      m_wakeup.wait_for(lock, st, m_options.m_flush_interval, [this] { return m_wake_requested; });
+      m_wake_requested = false;
+    }
+
+    Flush(batch);
+  }
+
+  Flush(batch);
+}
+
+void AsyncFileLogger::Flush(std::string& batch) {
+  DrainRings(batch);
+
+  if (batch.empty()) {
+    return;
+  }
+
+  WriteAll(batch);
+  batch.clear();
+
+  if (m_file_size >= m_options.m_max_file_size) {
+    Rotate(batch);
+  }
+}
+
+void AsyncFileLogger::DrainRings(std::string& batch) {
+  uint64_t dropped = 0;
+
+  {
+    std::lock_guard lock(m_buffers_mutex);
+
+    for (const auto& buffer : m_buffers) {
+      buffer->Drain(batch);
+      dropped += buffer->m_dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Forget rings whose threads have exited, once they are empty
+    std::erase_if(m_buffers, [&](const auto& buffer) {
+      if (buffer.use_count() != 1) {
+        return false;
+      }
+
+      buffer->Drain(batch);
+      return true;
+    });
+  }
+
+  if (dropped != 0) [[unlikely]] {
+    m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    batch += "[no3] " + std::to_string(dropped) + " log line(s) dropped\n";
+  }
+}
+
+void AsyncFileLogger::WriteAll(std::string_view data) {
+  if (m_fd == -1) [[unlikely]] {
+    return;
+  }
+
+  while (!data.empty()) {
+    const auto written = ::write(m_fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return;
+    }
+
+    data.remove_prefix(written);
+    m_file_size += written;
+  }
+}
+
+static auto RotatedPath(const std::filesystem::path& path, size_t index) -> std::filesystem::path {
+  auto rotated = path;
+  rotated += "." + std::to_string(index) + ".gz";
+  return rotated;
+}
+
+/// A name no earlier rotation has used, so a file left behind by a failed compression is never overwritten.
+static auto UniquePendingPath(const std::filesystem::path& path) -> std::filesystem::path {
+  const auto seconds =
+      std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+  for (size_t attempt = 0;; ++attempt) {
+    auto pending = path;
+    pending += "." + std::to_string(seconds);
+    if (attempt != 0) {
+      pending += "-" + std::to_string(attempt);
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::exists(pending, ec) && !ec) {
+      return pending;
+    }
+  }
+}
+
+auto AsyncFileLogger::CompressFile(const std::filesystem::path& source, const std::filesystem::path& target,
+                                   std::string& batch) -> bool {
+  const auto compressor = std::unique_ptr<libdeflate_compressor, decltype(&libdeflate_free_compressor)>(
+      libdeflate_alloc_compressor(kCompressionLevel), libdeflate_free_compressor);
+  std::ifstream in(source, std::ios::binary);
+  if (!compressor || !in) {
+    return false;
+  }
+
+  std::ofstream out(target, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  std::string chunk(kCompressionChunkSize, '\0');
+  std::string compressed(libdeflate_gzip_compress_bound(compressor.get(), chunk.size()), '\0');
+
+  // Each chunk becomes its own gzip member; gunzip and zcat read concatenated members back as one stream
+  while (out && in) {
+    in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    const auto chunk_size = static_cast<size_t>(in.gcount());
+    if (chunk_size == 0) {
+      break;
+    }
+
+    const auto compressed_size =
+        libdeflate_gzip_compress(compressor.get(), chunk.data(), chunk_size, compressed.data(), compressed.size());
+    if (compressed_size == 0) {
+      out.setstate(std::ios::failbit);
+      break;
+    }
+
+    out.write(compressed.data(), static_cast<std::streamsize>(compressed_size));
+
+    // Keep the rings moving, so logging threads do not start dropping lines while we compress
+    DrainRings(batch);
+    WriteAll(batch);
+    batch.clear();
+  }
+
+  const bool read_all = in.eof() && !in.bad();
+  out.close();
+
+  if (!read_all || !out.good()) {
+    // Never leave a truncated archive behind
+    std::error_code ec;
+    std::filesystem::remove(target, ec);
+    return false;
+  }
+
+  return true;
+}
+
+void AsyncFileLogger::Rotate(std::string& batch) {
+  std::error_code ec;
+
+  if (m_options.m_max_rotated_files == 0) {
+    // Nothing to keep; start over in place
+    if (::ftruncate(m_fd, 0) == 0) {
+      m_file_size = 0;
+    }
+    return;
+  }
+
+  // Shift <name>.N.gz to <name>.N+1.gz, discarding the oldest
+  std::filesystem::remove(RotatedPath(m_path, m_options.m_max_rotated_files), ec);
+  for (auto i = m_options.m_max_rotated_files; i > 1; --i) {
+    std::filesystem::rename(RotatedPath(m_path, i - 1), RotatedPath(m_path, i), ec);
+  }
+
+  const auto pending = UniquePendingPath(m_path);
+
+  std::filesystem::rename(m_path, pending, ec);
+  if (ec) {
+    return;
+  }
+
+  const auto fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    std::filesystem::rename(pending, m_path, ec);
+    return;
+  }
+
+  ::close(m_fd);
+  m_fd = fd;
+  m_file_size = 0;
+
+  // On failure the uncompressed file stays where it is, under its unique name
+  if (CompressFile(pending, RotatedPath(m_path, 1), batch)) {
+    std::filesystem::remove(pending, ec);
+  }
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Log sink that keeps disk I/O off the logging threads.
+   *
+   * Every thread that logs owns a lock-free single-producer ring; `Write()`
+   * only copies the line into it. A background thread periodically drains all
+   * rings into one batched `write()`, and rotates the file once it exceeds the
+   * configured size, compressing the previous file to `<name>.1.gz`. Lines
+   * that do not fit into a full ring are dropped and counted rather than
+   * stalling the caller.
+   *
+   * Compression works through the old file in bounded chunks and drains the
+   * rings between them. If it fails, the old file is kept uncompressed under a
+   * unique `<name>.<seconds>` name, which no later rotation overwrites.
+   */
+  class AsyncFileLogger final {
+  public:
+    struct Options {
+      size_t m_max_file_size = 16 * 1024 * 1024;
+      size_t m_max_rotated_files = 4;
+      size_t m_thread_buffer_size = 256 * 1024;
+      std::chrono::milliseconds m_flush_interval = std::chrono::milliseconds(100);
+    };
+
+    AsyncFileLogger(const AsyncFileLogger&) = delete;
+    AsyncFileLogger(AsyncFileLogger&&) = delete;
+    ~AsyncFileLogger();
+
+    [[nodiscard]] static auto Open(std::filesystem::path path, Options options) -> std::unique_ptr<AsyncFileLogger>;
+    [[nodiscard]] static auto Open(std::filesystem::path path) -> std::unique_ptr<AsyncFileLogger> {
+      return Open(std::move(path), Options());
+    }
+
+    /// Append one line; a trailing newline is added. Never blocks on I/O.
+    void Write(std::string_view line);
+
+    /// Lines dropped so far because a thread's ring was full.
+    [[nodiscard]] auto GetDroppedCount() const -> uint64_t { return m_dropped.load(std::memory_order_relaxed); }
+
+  private:
+    class ThreadBuffer;
+
+    std::filesystem::path m_path;
+    Options m_options;
+    int m_fd;
+    size_t m_file_size;
+    uint64_t m_id;
+    std::atomic<uint64_t> m_dropped = 0;
+
+    std::mutex m_buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+    std::condition_variable_any m_wakeup;
+    std::mutex m_wakeup_mutex;
+    bool m_wake_requested = false;  // guarded by m_wakeup_mutex
+    std::jthread m_flusher;
+
+    AsyncFileLogger(std::filesystem::path path, Options options, int fd, size_t file_size);
+
+    auto GetThreadBuffer() -> ThreadBuffer&;
+    void FlusherLoop(const std::stop_token& st);
+    void Flush(std::string& batch);
+    void DrainRings(std::string& batch);
+    void WriteAll(std::string_view data);
+    void Rotate(std::string& batch);
+    auto CompressFile(const std::filesystem::path& source, const std::filesystem::path& target, std::string& batch)
+        -> bool;
+  };
+}  // namespace no3::lsp::core
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Blocking multi-producer, multi-consumer FIFO with a fixed capacity.
+   *
+   * `Push()` blocks while the queue is full and `Pop()` blocks while it is
+   * empty. Once `Close()` is called, producers are rejected and consumers
+   * drain the remaining items before receiving `std::nullopt`.
+   */
+  template <typename T>
+  class BoundedQueue final {
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::deque<T> m_items;
+    size_t m_capacity;
+    bool m_closed = false;
+
+  public:
+    BoundedQueue(size_t capacity) : m_capacity(capacity) {}
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue(BoundedQueue&&) = delete;
+    ~BoundedQueue() = default;
+
+    [[nodiscard]] auto Push(T item) -> bool {
+      std::unique_lock lock(m_mutex);
+      m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+      if (m_closed) {
+        return false;
+      }
+
+      m_items.push_back(std::move(item));
+      lock.unlock();
+      m_not_empty.notify_one();
+
+      return true;
+    }
+
+    [[nodiscard]] auto Pop() -> std::optional<T> {
+      std::unique_lock lock(m_mutex);
+      m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+      if (m_items.empty()) {
+        return std::nullopt;
+      }
+
+      auto item = std::move(m_items.front());
+      m_items.pop_front();
+      lock.unlock();
+      m_not_full.notify_one();
+
+      return item;
+    }
+
+    void Close() {
+      {
+        std::lock_guard lock(m_mutex);
+        m_closed = true;
+      }
+
+      m_not_empty.notify_all();
+      m_not_full.notify_all();
+    }
+
+    [[nodiscard]] auto Size() -> size_t {
+      std::lock_guard lock(m_mutex);
+      return m_items.size();
+    }
+  };
+}  // namespace no3::lsp::core
@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <libdeflate.h>
+
+#include <algorithm>
+#include <lsp/server/ContentEncoding.hh>
+#include <nitrate-core/Logger.hh>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+/// Favor latency over ratio; LSP payloads are mostly repetitive JSON anyway.
+static constexpr int kCompressionLevel = 4;
+static constexpr size_t kMinDecompressBufferSize = 4096;
+static constexpr size_t kMaxDecompressedSize = 512 * 1024 * 1024;
+
+DeflateCompressor::DeflateCompressor() : m_compressor(libdeflate_alloc_compressor(kCompressionLevel)) {
+  if (m_compressor == nullptr) [[unlikely]] {
+    Log << "Failed to allocate the deflate compressor.";
+  }
+}
+
+DeflateCompressor::~DeflateCompressor() {
+  if (m_compressor != nullptr) {
+    libdeflate_free_compressor(m_compressor);
+  }
+}
+
+auto DeflateCompressor::Compress(std::string_view in, std::string& out) -> bool {
+  if (m_compressor == nullptr) [[unlikely]] {
+    return false;
+  }
+
+  out.resize(libdeflate_zlib_compress_bound(m_compressor, in.size()));
+
+  const auto compressed_size = libdeflate_zlib_compress(m_compressor, in.data(), in.size(), out.data(), out.size());
+  if (compressed_size == 0) [[unlikely]] {
+    Log << "DeflateCompressor: Failed to compress " << in.size() << " bytes";
+    return false;
+  }
+
+  out.resize(compressed_size);
+
+  return true;
+}
+
+DeflateDecompressor::DeflateDecompressor() : m_decompressor(libdeflate_alloc_decompressor()) {
+  if (m_decompressor == nullptr) [[unlikely]] {
+    Log << "Failed to allocate the deflate decompressor.";
+  }
+}
+
+DeflateDecompressor::~DeflateDecompressor() {
+  if (m_decompressor != nullptr) {
+    libdeflate_free_decompressor(m_decompressor);
+  }
+}
+
+auto DeflateDecompressor::Decompress(std::string_view in) -> std::optional<std::string_view> {
+  if (m_decompressor == nullptr) [[unlikely]] {
+    return std::nullopt;
+  }
+
+  auto& out = m_buffer;
+
+  // The zlib format does not record the decompressed size, so grow the buffer until it fits.
+  out.resize(std::max({out.capacity(), in.size() * 4, kMinDecompressBufferSize}));
+
+  while (true) {
+    size_t actual_size = 0;
+    const auto result =
+        libdeflate_zlib_decompress(m_decompressor, in.data(), in.size(), out.data(), out.size(), &actual_size);
+
+    switch (result) {
+      case LIBDEFLATE_SUCCESS: {
+        out.resize(actual_size);
+        return out;
+      }
+
+      case LIBDEFLATE_INSUFFICIENT_SPACE: {
+        if (out.size() >= kMaxDecompressedSize) [[unlikely]] {
+          Log << "DeflateDecompressor: Decompressed message exceeds " << kMaxDecompressedSize << " bytes";
+          return std::nullopt;
+        }
+
+        out.resize(std::min(out.size() * 2, kMaxDecompressedSize));
+        break;
+      }
+
+      default: {
+        Log << "DeflateDecompressor: Invalid deflate stream";
+        return std::nullopt;
+      }
+    }
+  }
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+struct libdeflate_compressor;
+struct libdeflate_decompressor;
+
+namespace no3::lsp::core {
+  /// The only `Content-Encoding` understood by the LSP framing layer. As in HTTP, `deflate` means a zlib
+  /// stream (RFC 1950) wrapping the deflate data, so that any standard zlib inflater can decode it.
+  static constexpr std::string_view kDeflateContentEncoding = "deflate";
+
+  /// Reusable zlib-wrapped deflate compressor. Not thread-safe; owned by one connection's writer thread.
+  class DeflateCompressor final {
+    libdeflate_compressor* m_compressor = nullptr;
+
+  public:
+    DeflateCompressor();
+    DeflateCompressor(const DeflateCompressor&) = delete;
+    DeflateCompressor(DeflateCompressor&&) = delete;
+    ~DeflateCompressor();
+
+    [[nodiscard]] auto Compress(std::string_view in, std::string& out) -> bool;
+  };
+
+  /// Reusable zlib-wrapped deflate decompressor. Not thread-safe; owned by one connection's reader thread.
+  class DeflateDecompressor final {
+    libdeflate_decompressor* m_decompressor = nullptr;
+    std::string m_buffer;
+
+  public:
+    DeflateDecompressor();
+    DeflateDecompressor(const DeflateDecompressor&) = delete;
+    DeflateDecompressor(DeflateDecompressor&&) = delete;
+    ~DeflateDecompressor();
+
+    /// The returned view is valid until the next call.
+    [[nodiscard]] auto Decompress(std::string_view in) -> std::optional<std::string_view>;
+  };
+}  // namespace no3::lsp::core
@@ -31,11 +31,14 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <lsp/protocol/LogTrace.hh>
+#include <core/trace/Trace.hh>
 #include <lsp/server/Context.hh>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
-#include <regex>
+
+#ifndef NDEBUG
+#include <fstream>
+#endif
 
 using namespace ncc;
 using namespace no3::lsp::core;
@@ -58,9 +61,23 @@ auto Context::ExecuteLSPRequest(const message::RequestMessage& message) -> messa
   const auto may_ignore = method.starts_with("$/");
   auto response = message.GetResponseObject();
 
+  const auto cancel = [&]() {
+    Log << Debug << log_prefix << "Request cancelled";
+    m_metrics.GetMethod(method).m_cancelled.fetch_add(1, std::memory_order_relaxed);
+    *response = {{"message", "Request cancelled"}};
+    response.SetStatusCode(StatusCode::RequestCancelled);
+    return std::move(response);
+  };
+
+  // Cancelled while it was still queued
+  if (message.IsCancelled()) {
+    return cancel();
+  }
+
   if (const auto is_initialize_request = method == "initialize"; m_is_lsp_initialized || is_initialize_request) {
     const auto route_it = LSP_REQUEST_MAP.find(method);
     if (route_it != LSP_REQUEST_MAP.end()) {
+      NO3_TRACE_SPAN("lsp.route", method);
       (*this.*route_it->second)(message, response);
     } else [[unlikely]] {
       if (may_ignore) [[likely]] {
@@ -76,6 +93,11 @@ auto Context::ExecuteLSPRequest(const message::RequestMessage& message) -> messa
     Log << Warning << log_prefix << "LSP not initialized, ignoring request";
   }
 
+  // A partial result computed after cancellation is of no use to the client
+  if (message.IsCancelled()) {
+    return cancel();
+  }
+
   return response;
 }
 
@@ -97,6 +119,7 @@ void Context::ExecuteLSPNotification(const message::NotifyMessage& message) {
   }
 
   if (m_is_lsp_initialized || (method == "initialized" || method == "exit")) {
+    NO3_TRACE_SPAN("lsp.route", method);
     (*this.*route_it->second)(message);
     return;
   }
@@ -104,11 +127,36 @@ void Context::ExecuteLSPNotification(const message::NotifyMessage& message) {
   Log << log_prefix << "LSP not initialized, ignoring notification";
 }
 
+void Context::OnDocumentSettled(const FlyString& file_uri, FileVersion version) {
+  auto file = m_fs.GetFile(file_uri);
+  if (!file.has_value() || (*file)->GetVersion() != version) {
+    // Closed, or edited again since; a later settle will cover it
+    return;
+  }
+
+  Log << Debug << "Context::OnDocumentSettled(): Text document settled: " << file_uri << " at version " << version;
+
+#ifndef NDEBUG
+  {
+    auto raw_content = *(*file)->ReadAll();
+
+    auto debug_output = std::fstream("/tmp/nitrate_lsp_debug.txt", std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!debug_output) {
+      qcore_panic("Failed to open debug output file");
+    }
+
+    debug_output.write(reinterpret_cast<const char*>(raw_content.c_str()), raw_content.size());
+  }
+#endif
+}
+
 void Context::ExecuteRPC(const message::Message& message, bool& exit_requested) {
   switch (const auto method = message.GetMethod(); message.GetKind()) {
     case MessageKind::Notification: {
       Log << Debug << "Context::ExecuteRPC(\"" << method << "\"): Executing LSP Notification";
+      const auto started_at = std::chrono::steady_clock::now();
       ExecuteLSPNotification(static_cast<const NotifyMessage&>(message));
+      m_metrics.GetMethod(method).m_execution.Record(std::chrono::steady_clock::now() - started_at);
       Log << Debug << "Context::ExecuteRPC(\"" << method << "\"): Finished LSP Notification";
 
       exit_requested = m_exit_requested;
@@ -118,12 +166,22 @@ void Context::ExecuteRPC(const message::Message& message, bool& exit_requested)
 
     case MessageKind::Request: {
       Log << Debug << "Context::ExecuteRPC(\"" << method << "\"): Executing LSP Request";
+      auto& metrics = m_metrics.GetMethod(method);
+      const auto started_at = std::chrono::steady_clock::now();
       auto response = ExecuteLSPRequest(static_cast<const RequestMessage&>(message));
+      const auto executed_at = std::chrono::steady_clock::now();
+      metrics.m_execution.Record(executed_at - started_at);
       Log << Debug << "Context::ExecuteRPC(\"" << method << "\"): Finished LSP Request";
 
       exit_requested = m_exit_requested;
 
       SendMessage(response);
+      metrics.m_serialization.Record(std::chrono::steady_clock::now() - executed_at);
+
+      if (m_deflate_threshold.has_value()) {
+        m_writer.EnableDeflate(*m_deflate_threshold);
+        m_deflate_threshold.reset();
+      }
 
       break;
     }
@@ -135,28 +193,38 @@ void Context::ExecuteRPC(const message::Message& message, bool& exit_requested)
 }
 
 void Context::SendMessage(Message& message, bool log_transmission) {
-  const auto json_response = nlohmann::to_string(*message.Finalize());
-
-  {  // Critical section
-    std::lock_guard lock(m_os_lock);
-    m_os << "Content-Length: " << json_response.size() << "\r\n";
-    m_os << "Content-Type: application/vscode-jsonrpc; charset=utf-8\r\n\r\n";
-    m_os << json_response;
-    m_os.flush();
-  }
+  auto json_response = nlohmann::to_string(*message.Finalize());
 
   if (log_transmission) {
-    Log << Trace << "SendJsonRPCMessage(): Wrote response: " << json_response;
+    Log << Trace << "SendJsonRPCMessage(): Queued response: " << json_response;
   }
+
+  m_writer.Enqueue(std::move(json_response));
 }
 
-static void StripANSI(std::string& str) {
-  static const std::regex ansi_escape(R"(\x1B\[[0-9;]*[A-Za-z])", std::regex_constants::optimize);
-  str = std::regex_replace(str, ansi_escape, "");
+auto Context::GetRoutedMethods() -> std::vector<std::string_view> {
+  std::vector<std::string_view> methods;
+  methods.reserve(LSP_REQUEST_MAP.size() + LSP_NOTIFICATION_MAP.size());
+
+  for (const auto& [method, _] : LSP_REQUEST_MAP) {
+    methods.push_back(method);
+  }
+
+  for (const auto& [method, _] : LSP_NOTIFICATION_MAP) {
+    methods.push_back(method);
+  }
+
+  return methods;
 }
 
-Context::Context(std::ostream& os, std::mutex& os_lock)
-    : m_os(os), m_os_lock(os_lock), m_fs(TextDocumentSyncKind::Incremental) {
+Context::Context(MessageWriter& writer)
+    : m_writer(writer),
+      m_trace_forwarder(writer),
+      m_metrics(GetRoutedMethods()),
+      m_fs(TextDocumentSyncKind::Incremental),
+      m_analysis_debouncer([this](const std::string& uri, int64_t version) {
+        OnDocumentSettled(FlyString(uri), version);
+      }) {
   static std::once_flag init_flag;
   std::call_once(init_flag, []() {
     Log << Trace << "Context::Context(): Initializing LSP context";
@@ -164,7 +232,7 @@ Context::Context(std::ostream& os, std::mutex& os_lock)
   });
 
   m_log_subscriber_id = Log->Subscribe([this](const ncc::LogMessage& log) {
-    if (!m_can_send_trace) {
+    if (!m_can_send_trace || GetThreadSessionTag() != m_session_tag) {
       return;
     }
 
@@ -186,12 +254,13 @@ Context::Context(std::ostream& os, std::mutex& os_lock)
       }
     }
 
-    auto message = log.m_by.Format(log.m_message, log.m_sev);
-    StripANSI(message);
-
-    auto trace_message = LogTraceNotification(std::move(message));
-    SendMessage(trace_message, false);
+    m_trace_forwarder.Submit(log.m_by.Format(log.m_message, log.m_sev));
   });
 }
 
-Context::~Context() { Log->Unsubscribe(m_log_subscriber_id); }
+Context::~Context() {
+  // The connection is going away; keep the summary in the local log only
+  m_can_send_trace = false;
+  Log << Info << "Context::~Context(): Server statistics: " << m_metrics.ToJson().dump();
+  Log->Unsubscribe(m_log_subscriber_id);
+}
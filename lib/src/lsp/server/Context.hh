@@ -34,14 +34,28 @@
 #pragma once
 
 #include <atomic>
+#include <optional>
 #include <lsp/protocol/Message.hh>
 #include <lsp/protocol/Notification.hh>
 #include <lsp/protocol/Request.hh>
 #include <lsp/protocol/Response.hh>
 #include <lsp/resource/FileBrowser.hh>
+#include <lsp/server/Debouncer.hh>
+#include <lsp/server/MessageWriter.hh>
+#include <lsp/server/Metrics.hh>
+#include <lsp/server/SessionTag.hh>
+#include <lsp/server/TraceForwarder.hh>
 #include <nitrate-core/Logger.hh>
+#include <vector>
 
 namespace no3::lsp::core {
+  /// How many requests of each priority class may wait to start before new ones are refused.
+  struct QueueLimits {
+    size_t m_interactive = 256;
+    size_t m_visible_range = 64;
+    size_t m_background = 32;
+  };
+
   class Context final {
     enum class TraceValue {
       Off,
@@ -49,17 +63,29 @@ namespace no3::lsp::core {
       Verbose,
     };
 
-    std::ostream& m_os;
-    std::mutex& m_os_lock;
+    MessageWriter& m_writer;
+    TraceForwarder m_trace_forwarder;
+    ServerMetrics m_metrics;
+    QueueLimits m_queue_limits;
 
     FileBrowser m_fs;
+    Debouncer m_analysis_debouncer;
     std::atomic<bool> m_is_lsp_initialized, m_can_send_trace, m_exit_requested;
     std::atomic<TraceValue> m_trace = TraceValue::Messages;
     ncc::LogSubscriberID m_log_subscriber_id;
 
+    /// Sessions share one logger; only lines logged by this session's threads are traced to its client.
+    SessionTag m_session_tag = GetThreadSessionTag();
+
+    /// Set by `initialize`; applied once its response has been queued, so that response is never compressed.
+    std::optional<size_t> m_deflate_threshold;
+
     [[nodiscard]] auto ExecuteLSPRequest(const message::RequestMessage& message) -> message::ResponseMessage;
     void ExecuteLSPNotification(const message::NotifyMessage& message);
 
+    /// Runs once per edit burst, after the document has settled at `version`.
+    void OnDocumentSettled(const FlyString& file_uri, FileVersion version);
+
     ///========================================================================================================
 
 #define LSP_REQUEST(name) void Request##name(const message::RequestMessage&, message::ResponseMessage&)
@@ -68,6 +94,7 @@ namespace no3::lsp::core {
     LSP_REQUEST(Initialize);
     LSP_REQUEST(Shutdown);
     LSP_REQUEST(Completion);
+    LSP_REQUEST(No3Stats);
 
     LSP_NOTIFY(Initialized);
     LSP_NOTIFY(SetTrace);
@@ -87,6 +114,8 @@ namespace no3::lsp::core {
         {"initialize", &Context::RequestInitialize},
         {"shutdown", &Context::RequestShutdown},
         {"textDocument/completion", &Context::RequestCompletion},
+
+        {"$/no3/stats", &Context::RequestNo3Stats},
     };
 
     static inline const std::unordered_map<std::string_view, LSPNotifyFunc> LSP_NOTIFICATION_MAP = {
@@ -100,15 +129,23 @@ namespace no3::lsp::core {
         {"textDocument/didSave", &Context::NotifyTextDocumentDidSave},
     };
 
+    /// Keys of both route maps; the only methods that get their own metrics.
+    static auto GetRoutedMethods() -> std::vector<std::string_view>;
+
     ///========================================================================================================
 
   public:
-    Context(std::ostream& os, std::mutex& os_lock);
+    Context(MessageWriter& writer);
     Context(const Context&) = delete;
     Context(Context&&) = delete;
     ~Context();
 
     void ExecuteRPC(const message::Message& message, bool& exit_requested);
     void SendMessage(message::Message& message, bool log_transmission = true);
+
+    [[nodiscard]] auto GetMetrics() -> ServerMetrics& { return m_metrics; }
+
+    /// Only changes during `initialize`, which runs with nothing else in flight.
+    [[nodiscard]] auto GetQueueLimits() const -> const QueueLimits& { return m_queue_limits; }
   };
 }  // namespace no3::lsp::core
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <algorithm>
+#include <lsp/server/Debouncer.hh>
+#include <lsp/server/SessionTag.hh>
+#include <nitrate-core/Logger.hh>
+#include <utility>
+#include <vector>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+auto Debouncer::GetDeadline(const Pending& pending) const -> Clock::time_point {
+  if (pending.m_flush) {
+    return pending.m_last_touch;
+  }
+
+  return std::min(pending.m_last_touch + m_quiet_period, pending.m_first_touch + m_max_latency);
+}
+
+void Debouncer::TimerLoop(const std::stop_token& st) {
+  std::vector<std::pair<std::string, int64_t>> due;
+  std::unique_lock lock(m_mutex);
+
+  while (!st.stop_requested()) {
+    if (m_pending.empty()) {
+      m_changed.wait(lock, st, [&] { return !m_pending.empty(); });
+      continue;
+    }
+
+    const auto now = Clock::now();
+    auto next_deadline = Clock::time_point::max();
+
+    std::erase_if(m_pending, [&](const auto& entry) {
+      const auto deadline = GetDeadline(entry.second);
+      if (deadline <= now) {
+        due.emplace_back(entry.first, entry.second.m_version);
+        return true;
+      }
+
+      next_deadline = std::min(next_deadline, deadline);
+      return false;
+    });
+
+    if (!due.empty()) {
+      lock.unlock();
+
+      for (const auto& [uri, version] : due) {
+        Log << Trace << "Debouncer: Document settled: " << uri << " at version " << version;
+        m_on_settled(uri, version);
+      }
+
+      due.clear();
+      lock.lock();
+      continue;
+    }
+
+    // Touches only ever push deadlines later, so only flushes and reconfiguration need to wake us
+    const auto generation = m_generation;
+    m_changed.wait_until(lock, st, next_deadline, [&] { return m_generation != generation; });
+  }
+}
+
+Debouncer::Debouncer(Callback on_settled)
+    : m_on_settled(std::move(on_settled)),
+      m_thread([this, parent_thread_logger = Log, session_tag = GetThreadSessionTag()](const std::stop_token& st) {
+        // Use the logger and session of the parent thread
+        Log = parent_thread_logger;
+        SetThreadSessionTag(session_tag);
+        TimerLoop(st);
+      }) {}
+
+Debouncer::~Debouncer() {
+  m_thread.request_stop();
+  m_changed.notify_all();
+}
+
+void Debouncer::SetTimings(std::chrono::milliseconds quiet_period, std::chrono::milliseconds max_latency) {
+  {
+    std::lock_guard lock(m_mutex);
+    m_quiet_period = quiet_period;
+    m_max_latency = std::max(max_latency, quiet_period);
+    ++m_generation;
+  }
+
+  m_changed.notify_all();
+}
+
+void Debouncer::Touch(const std::string& uri, int64_t version) {
+  const auto now = Clock::now();
+  bool was_idle = false;
+
+  {
+    std::lock_guard lock(m_mutex);
+    was_idle = m_pending.empty();
+
+    auto [it, inserted] = m_pending.try_emplace(uri, Pending{
+                                                         .m_version = version,
+                                                         .m_first_touch = now,
+                                                         .m_last_touch = now,
+                                                     });
+    if (!inserted) {
+      it->second.m_version = version;
+      it->second.m_last_touch = now;
+    }
+  }
+
+  if (was_idle) {
+    m_changed.notify_all();
+  }
+}
+
+void Debouncer::Flush(const std::string& uri) {
+  {
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_pending.find(uri);
+    if (it == m_pending.end()) {
+      return;
+    }
+
+    it->second.m_flush = true;
+    ++m_generation;
+  }
+
+  m_changed.notify_all();
+}
+
+void Debouncer::Cancel(const std::string& uri) {
+  std::lock_guard lock(m_mutex);
+  m_pending.erase(uri);
+}
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Per-document coalescing of work that depends on document content.
+   *
+   * Edits are applied to the text store immediately; only the work derived
+   * from them goes through here. A document becomes due once it has been quiet
+   * for the quiet period, or once the max latency has passed since the first
+   * edit of the burst, whichever comes first. The callback then runs once, on
+   * the timer thread, with the latest version seen. Heavy analysis should hand
+   * off from the callback rather than block other documents.
+   */
+  class Debouncer final {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void(const std::string& uri, int64_t version)>;
+
+    static constexpr auto kDefaultQuietPeriod = std::chrono::milliseconds(150);
+    static constexpr auto kDefaultMaxLatency = std::chrono::milliseconds(1000);
+
+  private:
+    struct Pending {
+      int64_t m_version;
+      Clock::time_point m_first_touch;
+      Clock::time_point m_last_touch;
+      bool m_flush = false;
+    };
+
+    Callback m_on_settled;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_changed;
+    std::unordered_map<std::string, Pending> m_pending;
+    std::chrono::milliseconds m_quiet_period = kDefaultQuietPeriod;
+    std::chrono::milliseconds m_max_latency = kDefaultMaxLatency;
+    uint64_t m_generation = 0;
+
+    std::jthread m_thread;
+
+    [[nodiscard]] auto GetDeadline(const Pending& pending) const -> Clock::time_point;
+    void TimerLoop(const std::stop_token& st);
+
+  public:
+    Debouncer(Callback on_settled);
+    Debouncer(const Debouncer&) = delete;
+    Debouncer(Debouncer&&) = delete;
+    ~Debouncer();
+
+    void SetTimings(std::chrono::milliseconds quiet_period, std::chrono::milliseconds max_latency);
+
+    /// Record an edit; restarts the quiet period but not the max-latency deadline.
+    void Touch(const std::string& uri, int64_t version);
+
+    /// Make a pending document due now, e.g. on save.
+    void Flush(const std::string& uri);
+
+    /// Drop pending work for a document that is no longer open.
+    void Cancel(const std::string& uri);
+  };
+}  // namespace no3::lsp::core
@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <charconv>
+#include <cstring>
+#include <lsp/server/FrameDecoder.hh>
+#include <nitrate-core/Assert.hh>
+#include <nitrate-core/Logger.hh>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+static constexpr size_t kMaxHeaderSize = 8 * 1024;
+
+static auto HttpHeaderStripWhitespace(std::string_view value) -> std::string_view {
+  const auto start = value.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    return {};
+  }
+
+  const auto end = value.find_last_not_of(" \t");
+  return value.substr(start, end - start + 1);
+}
+
+static auto HttpHeaderKeyEquals(std::string_view key, std::string_view expected) -> bool {
+  if (key.size() != expected.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < key.size(); ++i) {
+    const auto a = key[i] >= 'A' && key[i] <= 'Z' ? key[i] + ('a' - 'A') : key[i];
+    const auto b = expected[i] >= 'A' && expected[i] <= 'Z' ? expected[i] + ('a' - 'A') : expected[i];
+    if (a != b) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static auto FindEndOfHeaders(std::string_view pending) -> std::optional<size_t> {
+  size_t line_start = 0;
+
+  while (true) {
+    const auto newline = pending.find('\n', line_start);
+    if (newline == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    const auto line = pending.substr(line_start, newline - line_start);
+    if (line.empty() || line == "\r") {
+      return newline + 1;
+    }
+
+    line_start = newline + 1;
+  }
+}
+
+FrameDecoder::FrameDecoder(std::istream& in, size_t capacity) : m_in(in), m_buffer(std::max<size_t>(capacity, 1)) {
+  m_content_type.reserve(kDefaultContentType.size());
+  m_content_encoding.reserve(16);
+}
+
+void FrameDecoder::Reserve(size_t contiguous_bytes) {
+  if (m_head + contiguous_bytes <= m_buffer.size()) [[likely]] {
+    return;
+  }
+
+  const auto pending = m_tail - m_head;
+  if (pending > 0 && m_head > 0) {
+    std::memmove(m_buffer.data(), m_buffer.data() + m_head, pending);
+  }
+
+  m_head = 0;
+  m_tail = pending;
+
+  if (contiguous_bytes > m_buffer.size()) [[unlikely]] {
+    Log << Trace << "FrameDecoder: Growing buffer to fit a " << contiguous_bytes << " byte frame";
+    m_buffer.resize(std::max(contiguous_bytes, m_buffer.size() * 2));
+  }
+}
+
+auto FrameDecoder::Fill(size_t min_bytes) -> bool {
+  Reserve(min_bytes);
+
+  auto* buf = m_in.rdbuf();
+
+  while (m_tail - m_head < min_bytes) {
+    const auto space = static_cast<std::streamsize>(m_buffer.size() - m_tail);
+    const auto missing = static_cast<std::streamsize>(min_bytes - (m_tail - m_head));
+
+    // Block only for the bytes we need, but take anything that is already buffered.
+    const auto request = std::min(space, std::max(missing, buf->in_avail()));
+
+    const auto bytes_read = buf->sgetn(m_buffer.data() + m_tail, request);
+    if (bytes_read <= 0) [[unlikely]] {
+      m_eof = true;
+      return false;
+    }
+
+    m_tail += bytes_read;
+  }
+
+  return true;
+}
+
+auto FrameDecoder::ParseHeaders(std::optional<size_t>& content_length) -> bool {
+  std::optional<size_t> header_size;
+
+  while (!(header_size = FindEndOfHeaders({m_buffer.data() + m_head, m_tail - m_head}))) {
+    if (m_tail - m_head >= kMaxHeaderSize) [[unlikely]] {
+      Log << "FrameDecoder::ParseHeaders(): Header block exceeds " << kMaxHeaderSize << " bytes";
+      m_head = m_tail;
+      return false;
+    }
+
+    if (!Fill(m_tail - m_head + 1)) [[unlikely]] {
+      Log << "FrameDecoder::ParseHeaders(): Failed to read line";
+      return false;
+    }
+  }
+
+  auto headers = std::string_view(m_buffer.data() + m_head, *header_size);
+  m_head += *header_size;
+
+  if (headers.size() <= 2) [[unlikely]] {
+    Log << "FrameDecoder::ParseHeaders(): No headers found";
+    return false;
+  }
+
+  while (!headers.empty()) {
+    const auto newline = headers.find('\n');
+    auto line = headers.substr(0, newline);
+    headers.remove_prefix(newline + 1);
+
+    if (line.ends_with('\r')) {
+      line.remove_suffix(1);
+    }
+
+    if (line.empty()) {
+      break;
+    }
+
+    const auto colon = line.find(':');
+    if (colon == std::string_view::npos) [[unlikely]] {
+      Log << "FrameDecoder::ParseHeaders(): Invalid header format";
+      return false;
+    }
+
+    const auto key = HttpHeaderStripWhitespace(line.substr(0, colon));
+    const auto val = HttpHeaderStripWhitespace(line.substr(colon + 1));
+
+    Log << Trace << "FrameDecoder::ParseHeaders(): Result: (\"" << key << "\", \"" << val << "\")";
+
+    if (HttpHeaderKeyEquals(key, "Content-Length")) {
+      size_t value = 0;
+      const auto [ptr, ec] = std::from_chars(val.data(), val.data() + val.size(), value);
+      if (ec != std::errc() || ptr != val.data() + val.size()) [[unlikely]] {
+        Log << "FrameDecoder::ParseHeaders(): Invalid 'Content-Length' header value: \"" << val << "\"";
+        return false;
+      }
+
+      content_length = value;
+    } else if (HttpHeaderKeyEquals(key, "Content-Type")) {
+      m_content_type.assign(val);
+    } else if (HttpHeaderKeyEquals(key, "Content-Encoding")) {
+      m_content_encoding.assign(val);
+    }
+  }
+
+  return true;
+}
+
+auto FrameDecoder::Next() -> std::optional<Frame> {
+  m_head += m_consumed;
+  m_consumed = 0;
+
+  if (m_head == m_tail) {
+    m_head = m_tail = 0;
+  }
+
+  m_content_type.clear();
+  m_content_encoding.clear();
+
+  std::optional<size_t> content_length;
+  if (!ParseHeaders(content_length)) [[unlikely]] {
+    Log << "FrameDecoder::Next(): Failed to parse HTTP headers";
+    return std::nullopt;
+  }
+
+  if (!content_length.has_value()) [[unlikely]] {
+    Log << "FrameDecoder::Next(): Missing 'Content-Length' header";
+    return std::nullopt;
+  }
+
+  Log << Trace << "FrameDecoder::Next(): Content-Length: " << *content_length;
+
+  if (!Fill(*content_length)) [[unlikely]] {
+    Log << "FrameDecoder::Next(): Failed to read content";
+    return std::nullopt;
+  }
+
+  m_consumed = *content_length;
+
+  return Frame{
+      .m_content = std::string_view(m_buffer.data() + m_head, *content_length),
+      .m_content_type = m_content_type.empty() ? kDefaultContentType : std::string_view(m_content_type),
+      .m_content_encoding = m_content_encoding,
+  };
+}
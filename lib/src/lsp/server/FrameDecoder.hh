@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Streaming decoder for `Content-Length` delimited JSON-RPC frames.
+   *
+   * Input is read into a reusable buffer that is compacted in place between
+   * frames; it only grows when a single frame does not fit. Headers are parsed
+   * directly out of that buffer and the returned frame content is a view into
+   * it, so decoding a message does not allocate in the steady state.
+   */
+  class FrameDecoder final {
+  public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024;
+    static constexpr std::string_view kDefaultContentType = "application/vscode-jsonrpc; charset=utf-8";
+
+    struct Frame {
+      /// Valid until the next call to `Next()`.
+      std::string_view m_content;
+      std::string_view m_content_type;
+      /// Empty unless the peer sent a `Content-Encoding` header.
+      std::string_view m_content_encoding;
+    };
+
+    FrameDecoder(std::istream& in, size_t capacity = kDefaultCapacity);
+    FrameDecoder(const FrameDecoder&) = delete;
+    FrameDecoder(FrameDecoder&&) = delete;
+    ~FrameDecoder() = default;
+
+    [[nodiscard]] auto Next() -> std::optional<Frame>;
+    [[nodiscard]] auto IsEOF() const -> bool { return m_eof; }
+
+  private:
+    std::istream& m_in;
+    std::vector<char> m_buffer;
+    size_t m_head = 0;
+    size_t m_tail = 0;
+    size_t m_consumed = 0;
+    bool m_eof = false;
+    std::string m_content_type;
+    std::string m_content_encoding;
+
+    auto Reserve(size_t contiguous_bytes) -> void;
+    auto Fill(size_t min_bytes) -> bool;
+    auto ParseHeaders(std::optional<size_t>& content_length) -> bool;
+  };
+}  // namespace no3::lsp::core
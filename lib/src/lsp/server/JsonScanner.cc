@@ -0,0 +1,333 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <charconv>
+#include <cstring>
+#include <lsp/server/JsonScanner.hh>
+
+using namespace no3::lsp::core;
+
+static auto IsWhitespace(char ch) -> bool { return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t'; }
+
+static auto ParseHex4(std::string_view text, uint32_t& out) -> bool {
+  if (text.size() < 4) [[unlikely]] {
+    return false;
+  }
+
+  const auto* end = text.data() + 4;
+  const auto [ptr, ec] = std::from_chars(text.data(), end, out, 16);
+
+  return ec == std::errc() && ptr == end;
+}
+
+template <typename CharT>
+static void AppendUTF8(std::basic_string<CharT>& out, uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    out.push_back(static_cast<CharT>(codepoint));
+  } else if (codepoint < 0x800) {
+    out.push_back(static_cast<CharT>(0xC0 | (codepoint >> 6)));
+    out.push_back(static_cast<CharT>(0x80 | (codepoint & 0x3F)));
+  } else if (codepoint < 0x10000) {
+    out.push_back(static_cast<CharT>(0xE0 | (codepoint >> 12)));
+    out.push_back(static_cast<CharT>(0x80 | ((codepoint >> 6) & 0x3F)));
+    out.push_back(static_cast<CharT>(0x80 | (codepoint & 0x3F)));
+  } else {
+    out.push_back(static_cast<CharT>(0xF0 | (codepoint >> 18)));
+    out.push_back(static_cast<CharT>(0x80 | ((codepoint >> 12) & 0x3F)));
+    out.push_back(static_cast<CharT>(0x80 | ((codepoint >> 6) & 0x3F)));
+    out.push_back(static_cast<CharT>(0x80 | (codepoint & 0x3F)));
+  }
+}
+
+auto JsonScanner::SkipWhitespace() -> void {
+  while (m_pos < m_text.size() && IsWhitespace(m_text[m_pos])) {
+    ++m_pos;
+  }
+}
+
+auto JsonScanner::Consume(char ch) -> bool {
+  SkipWhitespace();
+
+  if (m_pos < m_text.size() && m_text[m_pos] == ch) {
+    ++m_pos;
+    return true;
+  }
+
+  return false;
+}
+
+auto JsonScanner::Peek() -> char {
+  SkipWhitespace();
+  return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+}
+
+auto JsonScanner::AtEnd() -> bool {
+  SkipWhitespace();
+  return m_pos == m_text.size();
+}
+
+auto JsonScanner::SkipString() -> bool {
+  if (!Consume('"')) [[unlikely]] {
+    return false;
+  }
+
+  while (m_pos < m_text.size()) {
+    const auto ch = m_text[m_pos++];
+    if (ch == '"') {
+      return true;
+    }
+
+    if (ch == '\\') {
+      ++m_pos;
+    }
+  }
+
+  return false;
+}
+
+auto JsonScanner::SkipLiteral(std::string_view literal) -> bool {
+  if (m_text.substr(m_pos, literal.size()) != literal) [[unlikely]] {
+    return false;
+  }
+
+  m_pos += literal.size();
+  return true;
+}
+
+auto JsonScanner::SkipNumber() -> bool {
+  const auto start = m_pos;
+
+  while (m_pos < m_text.size()) {
+    const auto ch = m_text[m_pos];
+    if ((ch < '0' || ch > '9') && ch != '-' && ch != '+' && ch != '.' && ch != 'e' && ch != 'E') {
+      break;
+    }
+
+    ++m_pos;
+  }
+
+  return m_pos != start;
+}
+
+auto JsonScanner::SkipValue(std::string_view* raw) -> bool {
+  SkipWhitespace();
+  const auto start = m_pos;
+
+  bool ok = false;
+  switch (Peek()) {
+    case '"': {
+      ok = SkipString();
+      break;
+    }
+
+    case '{': {
+      ok = ReadObject([](std::string_view, JsonScanner& value) { return value.SkipValue(); });
+      break;
+    }
+
+    case '[': {
+      ok = ReadArray([](JsonScanner& value) { return value.SkipValue(); });
+      break;
+    }
+
+    case 't': {
+      ok = SkipLiteral("true");
+      break;
+    }
+
+    case 'f': {
+      ok = SkipLiteral("false");
+      break;
+    }
+
+    case 'n': {
+      ok = SkipLiteral("null");
+      break;
+    }
+
+    default: {
+      ok = SkipNumber();
+      break;
+    }
+  }
+
+  if (ok && raw != nullptr) {
+    *raw = m_text.substr(start, m_pos - start);
+  }
+
+  return ok;
+}
+
+template <typename CharT>
+auto JsonScanner::ReadString(std::basic_string<CharT>& out) -> bool {
+  if (!Consume('"')) [[unlikely]] {
+    return false;
+  }
+
+  while (m_pos < m_text.size()) {
+    {  // Copy the longest run that needs no unescaping in one go
+      const auto rest = m_text.substr(m_pos);
+      const auto run = std::min(rest.find_first_of("\"\\"), rest.size());
+
+      out.append(reinterpret_cast<const CharT*>(rest.data()), run);
+      m_pos += run;
+    }
+
+    if (m_pos >= m_text.size()) [[unlikely]] {
+      break;
+    }
+
+    if (m_text[m_pos++] == '"') {
+      return true;
+    }
+
+    if (m_pos >= m_text.size()) [[unlikely]] {
+      break;
+    }
+
+    switch (m_text[m_pos++]) {
+      case '"': {
+        out.push_back('"');
+        break;
+      }
+
+      case '\\': {
+        out.push_back('\\');
+        break;
+      }
+
+      case '/': {
+        out.push_back('/');
+        break;
+      }
+
+      case 'b': {
+        out.push_back('\b');
+        break;
+      }
+
+      case 'f': {
+        out.push_back('\f');
+        break;
+      }
+
+      case 'n': {
+        out.push_back('\n');
+        break;
+      }
+
+      case 'r': {
+        out.push_back('\r');
+        break;
+      }
+
+      case 't': {
+        out.push_back('\t');
+        break;
+      }
+
+      case 'u': {
+        uint32_t codepoint = 0;
+        if (!ParseHex4(m_text.substr(m_pos), codepoint)) [[unlikely]] {
+          return false;
+        }
+        m_pos += 4;
+
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+          uint32_t low = 0;
+          if (m_text.substr(m_pos, 2) != "\\u" || !ParseHex4(m_text.substr(m_pos + 2), low) || low < 0xDC00 ||
+              low > 0xDFFF) [[unlikely]] {
+            return false;
+          }
+          m_pos += 6;
+
+          codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+        } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) [[unlikely]] {
+          return false;
+        }
+
+        AppendUTF8(out, codepoint);
+        break;
+      }
+
+      default: {
+        return false;
+      }
+    }
+  }
+
+  return false;
+}
+
+template auto JsonScanner::ReadString(std::basic_string<char>& out) -> bool;
+template auto JsonScanner::ReadString(std::basic_string<uint8_t>& out) -> bool;
+
+auto JsonScanner::ReadKey(std::string_view& key, std::string& scratch) -> bool {
+  SkipWhitespace();
+
+  // Keys practically never contain escapes, so hand out a view when possible
+  if (m_pos < m_text.size() && m_text[m_pos] == '"') {
+    const auto end = m_text.find_first_of("\"\\", m_pos + 1);
+    if (end != std::string_view::npos && m_text[end] == '"') {
+      key = m_text.substr(m_pos + 1, end - m_pos - 1);
+      m_pos = end + 1;
+      return true;
+    }
+  }
+
+  if (!ReadString(scratch)) [[unlikely]] {
+    return false;
+  }
+
+  key = scratch;
+  return true;
+}
+
+auto JsonScanner::ReadInteger(int64_t& out) -> bool {
+  SkipWhitespace();
+
+  const auto* begin = m_text.data() + m_pos;
+  const auto* end = m_text.data() + m_text.size();
+  const auto [ptr, ec] = std::from_chars(begin, end, out);
+  if (ec != std::errc()) [[unlikely]] {
+    return false;
+  }
+
+  // Reject fractions and exponents, which nlohmann would not report as integers either
+  if (ptr != end && (*ptr == '.' || *ptr == 'e' || *ptr == 'E')) [[unlikely]] {
+    return false;
+  }
+
+  m_pos += ptr - begin;
+  return true;
+}
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Forward-only, non-allocating cursor over a JSON document.
+   *
+   * Used on the hot ingest path to pull individual fields out of a message
+   * without materializing a DOM. Values that are not needed are skipped
+   * structurally; strings are only decoded when the caller asks for them, and
+   * then directly into the caller's buffer.
+   */
+  class JsonScanner final {
+    std::string_view m_text;
+    size_t m_pos = 0;
+    size_t m_depth = 0;
+
+    auto SkipWhitespace() -> void;
+    auto Consume(char ch) -> bool;
+    auto SkipString() -> bool;
+    auto SkipLiteral(std::string_view literal) -> bool;
+    auto SkipNumber() -> bool;
+    auto ReadKey(std::string_view& key, std::string& scratch) -> bool;
+
+  public:
+    static constexpr size_t kMaxDepth = 512;
+
+    JsonScanner(std::string_view text) : m_text(text) {}
+
+    [[nodiscard]] auto Peek() -> char;
+    [[nodiscard]] auto AtEnd() -> bool;
+
+    /// Skip over the next value, returning its raw text.
+    [[nodiscard]] auto SkipValue(std::string_view* raw = nullptr) -> bool;
+
+    /// Decode the next value, which must be a string, appending to `out`.
+    template <typename CharT>
+    [[nodiscard]] auto ReadString(std::basic_string<CharT>& out) -> bool;
+
+    /// Decode the next value, which must be an integer that fits in 64 bits.
+    [[nodiscard]] auto ReadInteger(int64_t& out) -> bool;
+
+    /// Iterate the members of the next value, which must be an object. The
+    /// callback must consume exactly one value per member.
+    template <typename Callback>
+    [[nodiscard]] auto ReadObject(Callback&& on_member) -> bool {
+      if (!Consume('{') || ++m_depth > kMaxDepth) [[unlikely]] {
+        return false;
+      }
+
+      if (Consume('}')) {
+        --m_depth;
+        return true;
+      }
+
+      do {
+        std::string scratch;
+        std::string_view key;
+        if (!ReadKey(key, scratch) || !Consume(':')) [[unlikely]] {
+          return false;
+        }
+
+        if (!on_member(key, *this)) [[unlikely]] {
+          return false;
+        }
+      } while (Consume(','));
+
+      --m_depth;
+      return Consume('}');
+    }
+
+    /// Iterate the elements of the next value, which must be an array. The
+    /// callback must consume exactly one value per element.
+    template <typename Callback>
+    [[nodiscard]] auto ReadArray(Callback&& on_element) -> bool {
+      if (!Consume('[') || ++m_depth > kMaxDepth) [[unlikely]] {
+        return false;
+      }
+
+      if (Consume(']')) {
+        --m_depth;
+        return true;
+      }
+
+      do {
+        if (!on_element(*this)) [[unlikely]] {
+          return false;
+        }
+      } while (Consume(','));
+
+      --m_depth;
+      return Consume(']');
+    }
+  };
+}  // namespace no3::lsp::core
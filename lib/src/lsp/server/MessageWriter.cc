@@ -0,0 +1,238 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <lsp/server/MessageWriter.hh>
+#include <lsp/server/SessionTag.hh>
+#include <nitrate-core/Logger.hh>
+#include <string_view>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+
+static constexpr std::string_view kContentLengthPrefix = "Content-Length: ";
+static constexpr std::string_view kContentTypeSuffix =
+    "\r\nContent-Type: application/vscode-jsonrpc; charset=utf-8\r\n";
+static constexpr std::string_view kContentEncodingLine = "Content-Encoding: deflate\r\n";
+static constexpr std::string_view kHeaderTerminator = "\r\n";
+static constexpr size_t kMaxHeaderSize = 192;
+
+using HeaderBuffer = std::array<char, kMaxHeaderSize>;
+
+static auto FormatHeader(HeaderBuffer& buffer, size_t content_length, bool deflated) -> size_t {
+  auto* ptr = buffer.data();
+
+  std::memcpy(ptr, kContentLengthPrefix.data(), kContentLengthPrefix.size());
+  ptr += kContentLengthPrefix.size();
+
+  ptr = std::to_chars(ptr, buffer.data() + buffer.size(), content_length).ptr;
+
+  std::memcpy(ptr, kContentTypeSuffix.data(), kContentTypeSuffix.size());
+  ptr += kContentTypeSuffix.size();
+
+  if (deflated) {
+    std::memcpy(ptr, kContentEncodingLine.data(), kContentEncodingLine.size());
+    ptr += kContentEncodingLine.size();
+  }
+
+  std::memcpy(ptr, kHeaderTerminator.data(), kHeaderTerminator.size());
+  ptr += kHeaderTerminator.size();
+
+  return ptr - buffer.data();
+}
+
+MessageWriter::MessageWriter(std::ostream& os)
+    : m_os(os), m_fd_buf(dynamic_cast<FileDescriptorStreamBuf*>(os.rdbuf())), m_head(&m_stub), m_tail(&m_stub) {
+  Log << Trace << "MessageWriter: Using " << (m_fd_buf != nullptr ? "gathered writev()" : "std::ostream")
+      << " output";
+
+  m_thread = std::jthread([this, parent_thread_logger = Log, session_tag = GetThreadSessionTag()]() {
+    // Use the logger and session of the parent thread
+    Log = parent_thread_logger;
+    SetThreadSessionTag(session_tag);
+    WriterLoop();
+  });
+}
+
+MessageWriter::~MessageWriter() {
+  m_stopping.store(true, std::memory_order_release);
+  m_signal.fetch_add(1, std::memory_order_release);
+  m_signal.notify_one();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void MessageWriter::Push(Node* node) {
+  node->m_next.store(nullptr, std::memory_order_relaxed);
+  auto* prev = m_head.exchange(node, std::memory_order_acq_rel);
+  prev->m_next.store(node, std::memory_order_release);
+}
+
+auto MessageWriter::Pop() -> Node* {
+  auto* tail = m_tail;
+  auto* next = tail->m_next.load(std::memory_order_acquire);
+
+  if (tail == &m_stub) {
+    if (next == nullptr) {
+      return nullptr;
+    }
+
+    m_tail = next;
+    tail = next;
+    next = next->m_next.load(std::memory_order_acquire);
+  }
+
+  if (next != nullptr) {
+    m_tail = next;
+    return tail;
+  }
+
+  if (tail != m_head.load(std::memory_order_acquire)) {
+    // A producer is in the middle of linking a new node
+    return nullptr;
+  }
+
+  Push(&m_stub);
+
+  next = tail->m_next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    m_tail = next;
+    return tail;
+  }
+
+  return nullptr;
+}
+
+void MessageWriter::Enqueue(std::string payload) {
+  const auto deflate_threshold = m_deflate_threshold.load(std::memory_order_relaxed);
+
+  auto* node = new Node;
+  node->m_deflate = deflate_threshold != 0 && payload.size() >= deflate_threshold;
+  node->m_payload = std::move(payload);
+
+  Push(node);
+
+  m_signal.fetch_add(1, std::memory_order_release);
+  m_signal.notify_one();
+}
+
+void MessageWriter::EnableDeflate(size_t threshold) {
+  Log << Trace << "MessageWriter: Deflating messages of at least " << threshold << " bytes";
+  m_deflate_threshold.store(std::max<size_t>(threshold, 1), std::memory_order_relaxed);
+}
+
+void MessageWriter::WriterLoop() {
+  Log << Trace << "MessageWriter: WriterLoop() started";
+
+  std::array<HeaderBuffer, kMaxBatchSize> headers;
+  std::array<iovec, kMaxBatchSize * 2> iov;
+  std::array<Node*, kMaxBatchSize> batch;
+
+  while (true) {
+    const auto ticket = m_signal.load(std::memory_order_acquire);
+
+    size_t count = 0;
+    while (count < kMaxBatchSize) {
+      auto* node = Pop();
+      if (node == nullptr) {
+        break;
+      }
+
+      batch[count++] = node;
+    }
+
+    if (count == 0) {
+      if (m_stopping.load(std::memory_order_acquire)) {
+        if (m_tail == &m_stub && m_head.load(std::memory_order_acquire) == &m_stub) {
+          break;
+        }
+
+        std::this_thread::yield();
+        continue;
+      }
+
+      m_signal.wait(ticket, std::memory_order_acquire);
+      continue;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      auto* node = batch[i];
+
+      // Only keep the compressed form when it is actually smaller
+      if (node->m_deflate) {
+        if (m_deflater.Compress(node->m_payload, m_deflated) && m_deflated.size() < node->m_payload.size()) {
+          std::swap(node->m_payload, m_deflated);
+        } else {
+          node->m_deflate = false;
+        }
+      }
+
+      const auto& payload = node->m_payload;
+      const auto header_size = FormatHeader(headers[i], payload.size(), node->m_deflate);
+
+      iov[i * 2] = {.iov_base = headers[i].data(), .iov_len = header_size};
+      iov[i * 2 + 1] = {.iov_base = const_cast<char*>(payload.data()), .iov_len = payload.size()};
+    }
+
+    if (m_fd_buf != nullptr) {
+      if (!m_fd_buf->WriteGather({iov.data(), count * 2})) [[unlikely]] {
+        Log << "MessageWriter: Failed to write " << count << " message(s)";
+      }
+    } else {
+      for (size_t i = 0; i < count * 2; ++i) {
+        m_os.write(static_cast<const char*>(iov[i].iov_base), static_cast<std::streamsize>(iov[i].iov_len));
+      }
+
+      // Only flush once the queue has been drained
+      if (count < kMaxBatchSize) {
+        m_os.flush();
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      delete batch[i];
+    }
+  }
+
+  m_os.flush();
+
+  Log << Trace << "MessageWriter: WriterLoop() stopped";
+}
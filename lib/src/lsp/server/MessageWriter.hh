@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <lsp/server/ContentEncoding.hh>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace no3::lsp::core {
+  class FileDescriptorStreamBuf;
+
+  /**
+   * @brief Single-threaded writer for outbound JSON-RPC messages.
+   *
+   * Any thread may enqueue a serialized message without blocking; a dedicated
+   * writer thread frames the queued messages and hands them to the transport in
+   * batches, so request handlers never wait on a slow client.
+   */
+  class MessageWriter final {
+    struct Node {
+      std::atomic<Node*> m_next = nullptr;
+      std::string m_payload;
+      bool m_deflate = false;
+    };
+
+    std::ostream& m_os;
+    FileDescriptorStreamBuf* m_fd_buf;
+
+    /// Intrusive MPSC queue (Vyukov). Producers swap `m_head`, the writer thread owns `m_tail`.
+    std::atomic<Node*> m_head;
+    Node* m_tail;
+    Node m_stub;
+
+    /// Zero while the peer has not negotiated `Content-Encoding: deflate`.
+    std::atomic<size_t> m_deflate_threshold = 0;
+    DeflateCompressor m_deflater;
+    std::string m_deflated;
+
+    std::atomic<uint64_t> m_signal = 0;
+    std::atomic<bool> m_stopping = false;
+    std::jthread m_thread;
+
+    void Push(Node* node);
+    auto Pop() -> Node*;
+    void WriterLoop();
+
+  public:
+    static constexpr size_t kMaxBatchSize = 64;
+
+    MessageWriter(std::ostream& os);
+    MessageWriter(const MessageWriter&) = delete;
+    MessageWriter(MessageWriter&&) = delete;
+    ~MessageWriter();
+
+    void Enqueue(std::string payload);
+
+    /// Compress every message enqueued from now on whose payload is at least `threshold` bytes.
+    void EnableDeflate(size_t threshold);
+  };
+}  // namespace no3::lsp::core
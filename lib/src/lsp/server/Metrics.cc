@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <lsp/server/Metrics.hh>
+
+using namespace no3::lsp::core;
+
+auto LatencyHistogram::GetBucketIndex(uint64_t value) -> size_t {
+  value = std::min<uint64_t>(value, (uint64_t(1) << kMaxValueBits) - 1);
+
+  if (value < kSubBucketCount) {
+    return value;
+  }
+
+  const auto shift = std::bit_width(value) - 1 - kSubBucketBits;
+  const auto sub_bucket = (value >> shift) & (kSubBucketCount - 1);
+
+  return (shift + 1) * kSubBucketCount + sub_bucket;
+}
+
+auto LatencyHistogram::GetBucketUpperBound(size_t index) -> uint64_t {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+
+  const auto shift = index / kSubBucketCount - 1;
+  const auto sub_bucket = index % kSubBucketCount;
+
+  return ((kSubBucketCount + sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(std::chrono::nanoseconds duration) {
+  const auto value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+
+  m_buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value, std::memory_order_relaxed);
+
+  auto max = m_max.load(std::memory_order_relaxed);
+  while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+auto LatencyHistogram::GetPercentile(double quantile) const -> std::chrono::nanoseconds {
+  const auto count = GetCount();
+  if (count == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+
+  const auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count))), 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += m_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      // Never report more than was actually observed
+      const auto value = std::min(GetBucketUpperBound(i), m_max.load(std::memory_order_relaxed));
+      return std::chrono::nanoseconds(value);
+    }
+  }
+
+  return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+}
+
+auto LatencyHistogram::ToJson() const -> nlohmann::json {
+  const auto to_us = [](auto ns) { return static_cast<double>(ns) / 1000.0; };
+  const auto count = GetCount();
+
+  return {
+      {"count", count},
+      {"mean_us", count == 0 ? 0.0 : to_us(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(count)},
+      {"p50_us", to_us(GetPercentile(0.50).count())},
+      {"p90_us", to_us(GetPercentile(0.90).count())},
+      {"p99_us", to_us(GetPercentile(0.99).count())},
+      {"max_us", to_us(m_max.load(std::memory_order_relaxed))},
+  };
+}
+
+ServerMetrics::ServerMetrics(std::span<const std::string_view> methods) {
+  for (const auto method : methods) {
+    m_methods.try_emplace(std::string(method), std::make_unique<MethodMetrics>());
+  }
+
+  auto [it, _] = m_methods.try_emplace(std::string(kUnknownMethod), std::make_unique<MethodMetrics>());
+  m_unknown_method = it->second.get();
+}
+
+auto ServerMetrics::GetMethod(std::string_view method) -> MethodMetrics& {
+  if (auto it = m_methods.find(method); it != m_methods.end()) [[likely]] {
+    return *it->second;
+  }
+
+  return *m_unknown_method;
+}
+
+void ServerMetrics::OnEnqueued() {
+  const auto depth = m_queue_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  auto max = m_max_queue_depth.load(std::memory_order_relaxed);
+  while (depth > max && !m_max_queue_depth.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+  }
+}
+
+void ServerMetrics::OnDequeued(std::string_view method, std::chrono::nanoseconds queue_wait) {
+  m_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+  GetMethod(method).m_queue_wait.Record(queue_wait);
+}
+
+void ServerMetrics::OnDropped(std::string_view method) {
+  m_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+  GetMethod(method).m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnShed(std::string_view method) {
+  m_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+  GetMethod(method).m_shed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnCollapsed(std::string_view method) {
+  m_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+  GetMethod(method).m_collapsed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::OnWorkerIdle(std::chrono::nanoseconds busy_for) {
+  m_busy_nanoseconds.fetch_add(busy_for.count(), std::memory_order_relaxed);
+  m_busy_workers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+auto ServerMetrics::ToJson() const -> nlohmann::json {
+  const auto uptime = std::chrono::steady_clock::now() - m_started_at;
+  const auto uptime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(uptime).count();
+  const auto worker_count = m_worker_count.load(std::memory_order_relaxed);
+
+  double utilization = 0.0;
+  if (uptime_ns > 0 && worker_count > 0) {
+    utilization = static_cast<double>(m_busy_nanoseconds.load(std::memory_order_relaxed)) /
+                  (static_cast<double>(uptime_ns) * static_cast<double>(worker_count));
+  }
+
+  nlohmann::json j;
+  j["uptime_ms"] = uptime_ns / 1000000;
+  j["queue"]["depth"] = m_queue_depth.load(std::memory_order_relaxed);
+  j["queue"]["max_depth"] = m_max_queue_depth.load(std::memory_order_relaxed);
+  j["workers"]["count"] = worker_count;
+  j["workers"]["busy"] = m_busy_workers.load(std::memory_order_relaxed);
+  j["workers"]["utilization"] = utilization;
+
+  uint64_t cancelled = 0;
+  uint64_t dropped = 0;
+  uint64_t shed = 0;
+  uint64_t collapsed = 0;
+  j["methods"] = nlohmann::json::object();
+
+  for (const auto& [name, metrics] : m_methods) {
+    cancelled += metrics->m_cancelled.load(std::memory_order_relaxed);
+    dropped += metrics->m_dropped.load(std::memory_order_relaxed);
+    shed += metrics->m_shed.load(std::memory_order_relaxed);
+    collapsed += metrics->m_collapsed.load(std::memory_order_relaxed);
+
+    // Every routed method has an entry; only report the ones that have seen traffic
+    const auto is_idle = metrics->m_queue_wait.GetCount() == 0 && metrics->m_execution.GetCount() == 0 &&
+                         metrics->m_dropped.load(std::memory_order_relaxed) == 0 &&
+                         metrics->m_shed.load(std::memory_order_relaxed) == 0 &&
+                         metrics->m_collapsed.load(std::memory_order_relaxed) == 0;
+    if (is_idle) {
+      continue;
+    }
+
+    j["methods"][name] = {
+        {"queue_wait", metrics->m_queue_wait.ToJson()},
+        {"execution", metrics->m_execution.ToJson()},
+        {"serialization", metrics->m_serialization.ToJson()},
+        {"cancelled", metrics->m_cancelled.load(std::memory_order_relaxed)},
+        {"dropped", metrics->m_dropped.load(std::memory_order_relaxed)},
+        {"shed", metrics->m_shed.load(std::memory_order_relaxed)},
+        {"collapsed", metrics->m_collapsed.load(std::memory_order_relaxed)},
+    };
+  }
+
+  j["cancelled"] = cancelled;
+  j["dropped"] = dropped;
+  j["shed"] = shed;
+  j["collapsed"] = collapsed;
+
+  return j;
+}
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Lock-free log-linear latency histogram.
+   *
+   * Each power of two is split into 16 linear sub-buckets, so any recorded
+   * value is reported within 1/16 of its true magnitude, the same trade-off an
+   * HDR histogram with one significant digit makes. Recording is a handful of
+   * relaxed atomic increments and never allocates.
+   */
+  class LatencyHistogram final {
+    static constexpr size_t kSubBucketBits = 4;
+    static constexpr size_t kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr size_t kMaxValueBits = 40;  // ~18 minutes in nanoseconds
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    std::array<std::atomic<uint64_t>, kBucketCount> m_buckets{};
+    std::atomic<uint64_t> m_count = 0;
+    std::atomic<uint64_t> m_sum = 0;
+    std::atomic<uint64_t> m_max = 0;
+
+    static auto GetBucketIndex(uint64_t value) -> size_t;
+    static auto GetBucketUpperBound(size_t index) -> uint64_t;
+
+  public:
+    void Record(std::chrono::nanoseconds duration);
+
+    [[nodiscard]] auto GetCount() const -> uint64_t { return m_count.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto GetPercentile(double quantile) const -> std::chrono::nanoseconds;
+
+    /// Count, mean, p50, p90, p99 and max, in microseconds.
+    [[nodiscard]] auto ToJson() const -> nlohmann::json;
+  };
+
+  /**
+   * @brief Server-wide load and latency counters, readable through `$/no3/stats`.
+   */
+  class ServerMetrics final {
+  public:
+    struct MethodMetrics {
+      LatencyHistogram m_queue_wait;
+      LatencyHistogram m_execution;
+      LatencyHistogram m_serialization;
+      std::atomic<uint64_t> m_cancelled = 0;
+      std::atomic<uint64_t> m_dropped = 0;
+      std::atomic<uint64_t> m_shed = 0;
+      std::atomic<uint64_t> m_collapsed = 0;
+    };
+
+  private:
+    std::chrono::steady_clock::time_point m_started_at = std::chrono::steady_clock::now();
+
+    /// Fixed at construction, so lookups need no lock and clients can not grow it.
+    std::map<std::string, std::unique_ptr<MethodMetrics>, std::less<>> m_methods;
+    MethodMetrics* m_unknown_method;
+
+    std::atomic<uint64_t> m_queue_depth = 0;
+    std::atomic<uint64_t> m_max_queue_depth = 0;
+    std::atomic<uint64_t> m_busy_workers = 0;
+    std::atomic<uint64_t> m_busy_nanoseconds = 0;
+    std::atomic<uint64_t> m_worker_count = 0;
+
+  public:
+    static constexpr std::string_view kUnknownMethod = "<unknown>";
+
+    /// Only `methods` get their own entry; everything else is folded into `kUnknownMethod`.
+    ServerMetrics(std::span<const std::string_view> methods);
+    ServerMetrics(const ServerMetrics&) = delete;
+    ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+    /// Stable for the lifetime of this object.
+    [[nodiscard]] auto GetMethod(std::string_view method) -> MethodMetrics&;
+
+    void SetWorkerCount(size_t worker_count) { m_worker_count.store(worker_count, std::memory_order_relaxed); }
+
+    void OnEnqueued();
+    void OnDequeued(std::string_view method, std::chrono::nanoseconds queue_wait);
+    void OnDropped(std::string_view method);
+    void OnShed(std::string_view method);
+    void OnCollapsed(std::string_view method);
+    void OnWorkerBusy() { m_busy_workers.fetch_add(1, std::memory_order_relaxed); }
+    void OnWorkerIdle(std::chrono::nanoseconds busy_for);
+
+    [[nodiscard]] auto ToJson() const -> nlohmann::json;
+  };
+}  // namespace no3::lsp::core
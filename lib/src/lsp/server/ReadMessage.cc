@@ -31,9 +31,11 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <charconv>
+#include <core/trace/Trace.hh>
 #include <lsp/protocol/Notification.hh>
 #include <lsp/protocol/Request.hh>
+#include <lsp/server/ContentEncoding.hh>
+#include <lsp/server/JsonScanner.hh>
 #include <lsp/server/Server.hh>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
@@ -42,207 +44,148 @@ using namespace ncc;
 using namespace no3::lsp::core;
 using namespace no3::lsp::message;
 
-struct HttpMessage {
-  std::unordered_map<std::string, std::string> m_headers;
-  std::string m_content;
-};
-
-static std::string HttpHeaderStripWhitespace(std::string value) {
-  auto start = value.find_first_not_of(" \t");
-  if (start != std::string::npos) {
-    value.erase(0, start);
-  }
-
-  auto end = value.find_last_not_of(" \t");
-  if (end != std::string::npos) {
-    value.erase(end + 1);
-  }
-
-  return value;
-}
-
-static auto ParseHttpHeader(std::istream& in,
-                            bool& end_of_headers) -> std::optional<std::pair<std::string, std::string>> {
-  end_of_headers = false;
-
-  std::string line;
-  std::getline(in, line);
-  if (!in) [[unlikely]] {
-    Log << "ParseHttpHeader(): Failed to read line";
-    return std::nullopt;
-  }
-
-  if (line.ends_with("\r")) {
-    line = line.substr(0, line.size() - 1);
-  }
-
-  if (line.empty()) [[unlikely]] {
-    Log << Trace << "ParseHttpHeader(): End of headers";
-    end_of_headers = true;
-    return std::nullopt;
-  }
-
-  auto pos = line.find(':');
-  if (pos == std::string::npos) [[unlikely]] {
-    Log << "ParseHttpHeader(): Invalid header format";
-    return std::nullopt;
-  }
-
-  auto key = HttpHeaderStripWhitespace(line.substr(0, pos));
-  auto val = HttpHeaderStripWhitespace(line.substr(pos + 1));
-
-  Log << Trace << "ParseHttpHeader(): Result: (\"" << key << "\", \"" << val << "\")";
-
-  return std::make_pair(key, val);
-}
-
-static auto ParseHttpMessage(std::istream& in) -> std::optional<HttpMessage> {
-  std::unordered_map<std::string, std::string> headers;
-
-  while (true) {
-    bool end_of_headers = false;
-    auto header = ParseHttpHeader(in, end_of_headers);
-    if (end_of_headers) {
-      break;
+namespace {
+  /// The top-level members of a JSON-RPC message. `params` is left unparsed.
+  struct JsonRpcEnvelope {
+    std::optional<std::string> m_jsonrpc;
+    std::optional<std::string> m_method;
+    std::optional<MessageSequenceID> m_id;
+    std::string_view m_params;
+    bool m_has_id = false;
+    bool m_id_is_valid = true;
+  };
+}  // namespace
+
+static auto ScanJsonRPCEnvelope(std::string_view content) -> std::optional<JsonRpcEnvelope> {
+  JsonRpcEnvelope envelope;
+  JsonScanner scanner(content);
+
+  const auto ok = scanner.ReadObject([&](std::string_view key, JsonScanner& value) {
+    if (key == "jsonrpc" && value.Peek() == '"') {
+      return value.ReadString(envelope.m_jsonrpc.emplace());
     }
 
-    if (!header.has_value()) [[unlikely]] {
-      Log << "ParseHttpMessage(): Failed to parse HTTP header";
-      return std::nullopt;
+    if (key == "method" && value.Peek() == '"') {
+      return value.ReadString(envelope.m_method.emplace());
     }
 
-    headers[header->first] = header->second;
-  }
+    if (key == "id") {
+      envelope.m_has_id = true;
 
-  if (headers.empty()) [[unlikely]] {
-    Log << "ParseHttpMessage(): No headers found";
-    return std::nullopt;
-  }
+      if (value.Peek() == '"') {
+        std::string id;
+        if (!value.ReadString(id)) [[unlikely]] {
+          return false;
+        }
 
-  if (!headers.contains("Content-Length")) [[unlikely]] {
-    Log << "ParseHttpMessage(): Missing 'Content-Length' header";
-    return std::nullopt;
-  }
+        envelope.m_id = std::move(id);
+        return true;
+      }
 
-  if (!headers.contains("Content-Type")) [[unlikely]] {
-    constexpr auto kDefaultContentType = "application/vscode-jsonrpc; charset=utf-8";
-    headers["Content-Type"] = kDefaultContentType;
-  }
+      if (int64_t id = 0; value.ReadInteger(id)) {
+        envelope.m_id = id;
+        return true;
+      }
 
-  const auto& content_length = headers.at("Content-Length");
-  std::streamsize content_length_value = 0;
-
-  if (std::from_chars(content_length.data(), content_length.data() + content_length.size(), content_length_value).ec !=
-      std::errc()) {
-    Log << "ParseHttpMessage(): Invalid 'Content-Length' header value: \"" << content_length << "\"";
-    return std::nullopt;
-  }
+      envelope.m_id_is_valid = false;
+      return value.SkipValue();
+    }
 
-  Log << Trace << "ParseHttpMessage(): Content-Length: " << content_length_value;
+    if (key == "params") {
+      return value.SkipValue(&envelope.m_params);
+    }
 
-  std::string content;
-  content.resize(content_length_value);
-  if (!in.read(content.data(), content_length_value)) [[unlikely]] {
-    Log << "ParseHttpMessage(): Failed to read content";
-    return std::nullopt;
-  }
+    return value.SkipValue();
+  });
 
-  if (in.gcount() != content_length_value) [[unlikely]] {
-    Log << "ParseHttpMessage(): Read content size mismatch";
+  if (!ok || !scanner.AtEnd()) [[unlikely]] {
     return std::nullopt;
   }
 
-  Log << Trace << "ParseHttpMessage(): Content: " << content;
-
-  return HttpMessage{std::move(headers), std::move(content)};
+  return envelope;
 }
 
-static auto QuickJsonRPCMessageCheck(const nlohmann::json& json_rpc) -> bool {
-  if (!json_rpc.contains("jsonrpc")) [[unlikely]] {
-    Log << "QuickJsonRPCMessageCheck(): Missing 'jsonrpc' field";
+static auto QuickJsonRPCMessageCheck(const JsonRpcEnvelope& envelope) -> bool {
+  if (!envelope.m_jsonrpc.has_value()) [[unlikely]] {
+    Log << "QuickJsonRPCMessageCheck(): Missing 'jsonrpc' string field";
     return false;
   }
 
-  if (!json_rpc["jsonrpc"].is_string()) [[unlikely]] {
-    Log << "QuickJsonRPCMessageCheck(): 'jsonrpc' field is not a string";
-    return false;
-  }
-
-  if (json_rpc["jsonrpc"] != "2.0") [[unlikely]] {
+  if (*envelope.m_jsonrpc != "2.0") [[unlikely]] {
     Log << "QuickJsonRPCMessageCheck(): 'jsonrpc' field is not '2.0'";
     return false;
   }
 
-  if (!json_rpc.contains("method")) [[unlikely]] {
-    Log << "QuickJsonRPCMessageCheck(): Missing 'method' field";
+  if (!envelope.m_method.has_value()) [[unlikely]] {
+    Log << "QuickJsonRPCMessageCheck(): Missing 'method' string field";
     return false;
   }
 
-  if (!json_rpc["method"].is_string()) [[unlikely]] {
-    Log << "QuickJsonRPCMessageCheck(): 'method' field is not a string";
+  if (envelope.m_has_id && !envelope.m_id_is_valid) [[unlikely]] {
+    Log << "QuickJsonRPCMessageCheck(): 'id' field is not a string or integer";
     return false;
   }
 
-  if (json_rpc.contains("id")) {
-    if (!json_rpc["id"].is_string() && !json_rpc["id"].is_number_integer()) [[unlikely]] {
-      Log << "QuickJsonRPCMessageCheck(): 'id' field is not a string or integer";
-      return false;
-    }
-  }
-
   return true;
 }
 
-static auto ConvertRPCMessageToLSPMessage(nlohmann::json json_rpc) -> std::unique_ptr<Message> {
-  auto method = json_rpc["method"].get<std::string>();
-  auto params = json_rpc.contains("params") ? std::move(json_rpc["params"]) : nlohmann::json{};
+static auto ConvertRPCMessageToLSPMessage(JsonRpcEnvelope envelope) -> std::unique_ptr<Message> {
+  auto method = std::move(envelope.m_method.value());
+  auto params = RawJson{std::string(envelope.m_params)};
 
-  if (bool is_notification = !json_rpc.contains("id")) {
+  if (bool is_notification = !envelope.m_has_id) {
     return std::make_unique<NotifyMessage>(std::move(method), std::move(params));
   }
 
-  auto id = std::move(json_rpc["id"]);
-  if (id.is_number_integer()) {
-    return std::make_unique<RequestMessage>(std::move(method), id.get<int64_t>(), std::move(params));
-  }
-
-  if (id.is_string()) {
-    return std::make_unique<RequestMessage>(std::move(method), id.get<std::string>(), std::move(params));
-  }
-
-  qcore_panic("unreachable");
+  return std::make_unique<RequestMessage>(std::move(method), std::move(envelope.m_id.value()), std::move(params));
 }
 
-auto Server::ReadRequest(std::istream& in, std::mutex& in_lock) -> std::optional<std::unique_ptr<Message>> {
+auto Server::ReadRequest(FrameDecoder& in, DeflateDecompressor& inflater,
+                         std::mutex& in_lock) -> std::optional<std::unique_ptr<Message>> {
   std::lock_guard lock(in_lock);
-  if (in.eof()) [[unlikely]] {
+  if (in.IsEOF()) [[unlikely]] {
     Log << "ReadRequest(): EOF reached";
     return std::nullopt;
   }
 
-  if (!in) [[unlikely]] {
-    Log << "ReadRequest(): Bad stream";
-    return std::nullopt;
-  }
-
-  auto http_message = ParseHttpMessage(in);
-  if (!http_message.has_value()) [[unlikely]] {
+  auto frame = in.Next();
+  if (!frame.has_value()) [[unlikely]] {
     Log << "ReadRequest(): Failed to parse HTTP message";
     return std::nullopt;
   }
 
-  const auto& message = http_message.value();
+  // Starts once a frame has arrived, so time spent blocked on the client is not counted
+  NO3_TRACE_SPAN("lsp", "ReadRequest::Decode");
+
+  auto content = frame->m_content;
+
+  if (!frame->m_content_encoding.empty()) {
+    if (frame->m_content_encoding != kDeflateContentEncoding) [[unlikely]] {
+      Log << "ReadRequest(): Unsupported 'Content-Encoding': \"" << frame->m_content_encoding << "\"";
+      return std::nullopt;
+    }
+
+    auto inflated = inflater.Decompress(content);
+    if (!inflated.has_value()) [[unlikely]] {
+      Log << "ReadRequest(): Failed to decompress message";
+      return std::nullopt;
+    }
+
+    Log << Trace << "ReadRequest(): Inflated " << content.size() << " bytes to " << inflated->size() << " bytes";
+    content = *inflated;
+  }
 
-  auto json_rpc = nlohmann::json::parse(message.m_content, nullptr, false);
-  if (json_rpc.is_discarded()) [[unlikely]] {
+  // Route on the envelope alone; `params` is only parsed if and when a handler needs it
+  auto envelope = ScanJsonRPCEnvelope(content);
+  if (!envelope.has_value()) [[unlikely]] {
     Log << "ReadRequest(): Failed to parse JSON-RPC message";
     return std::nullopt;
   }
 
-  if (!QuickJsonRPCMessageCheck(json_rpc)) [[unlikely]] {
+  if (!QuickJsonRPCMessageCheck(*envelope)) [[unlikely]] {
     Log << "ReadRequest(): Invalid LSP JSON-RPC message";
     return std::nullopt;
   }
 
-  return ConvertRPCMessageToLSPMessage(std::move(json_rpc));
+  return ConvertRPCMessageToLSPMessage(std::move(*envelope));
 }
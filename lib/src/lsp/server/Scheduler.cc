@@ -31,50 +31,592 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <core/trace/Trace.hh>
 #include <lsp/protocol/Base.hh>
+#include <lsp/protocol/Request.hh>
+#include <lsp/server/JsonScanner.hh>
 #include <lsp/server/Scheduler.hh>
 #include <memory>
 #include <mutex>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
 #include <nlohmann/json.hpp>
-#include <unordered_set>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using namespace ncc;
 using namespace no3::lsp::core;
 using namespace no3::lsp::message;
 using namespace no3::lsp::protocol;
 
+namespace {
+  enum class Ordering : uint8_t {
+    /// Runs alone, after every previously scheduled message has finished.
+    Barrier,
+    /// Runs on the pool without any ordering constraints.
+    Concurrent,
+    /// Runs in parallel with other reads of the same document, but never alongside a write to it.
+    DocumentRead,
+    /// Runs exclusively with respect to everything else on the same document.
+    DocumentWrite,
+  };
+
+  enum class Priority : uint8_t {
+    /// The user is waiting on it right now (edits, completion, hover).
+    Interactive,
+    /// Affects what is on screen, but not the keystroke at hand.
+    VisibleRange,
+    /// Whole-document or workspace-wide analysis.
+    Background,
+  };
+
+  static constexpr size_t kPriorityCount = 3;
+
+  struct MethodPolicy {
+    Ordering m_ordering;
+    Priority m_priority;
+  };
+
+  /// Messages that target one document, in arrival order.
+  struct Strand {
+    struct Item {
+      std::unique_ptr<Message> m_message;
+      bool m_is_write;
+      Priority m_priority;
+      std::chrono::steady_clock::time_point m_scheduled_at;
+      /// The document version this message was scheduled against.
+      std::optional<int64_t> m_version;
+    };
+
+    std::string m_uri;
+    /// The newest version announced by a write scheduled on this strand.
+    std::optional<int64_t> m_version;
+    std::deque<Item> m_queue;
+    size_t m_active_readers = 0;
+    bool m_active_writer = false;
+  };
+}  // namespace
+
+static auto GetPolicy(std::string_view method) -> MethodPolicy {
+  using enum Ordering;
+  using enum Priority;
+
+  static const std::unordered_map<std::string_view, MethodPolicy> policies = {
+      ///========================================================================
+      /// BEGIN: LSP Lifecycle messages
+      {"$/setTrace", {Concurrent, Interactive}},
+      {"$/no3/stats", {Concurrent, Interactive}},
+
+      ///========================================================================
+      /// BEGIN: LSP Document Synchronization messages
+      {"textDocument/didOpen", {DocumentWrite, Interactive}},
+      {"textDocument/didChange", {DocumentWrite, Interactive}},
+      {"textDocument/willSave", {DocumentWrite, Interactive}},
+      {"textDocument/didSave", {DocumentWrite, Interactive}},
+      {"textDocument/didClose", {DocumentWrite, Interactive}},
+
+      ///========================================================================
+      /// BEGIN: LSP Feature messages
+      {"textDocument/completion", {DocumentRead, Interactive}},
+      {"textDocument/hover", {DocumentRead, Interactive}},
+      {"textDocument/signatureHelp", {DocumentRead, Interactive}},
+      {"textDocument/definition", {DocumentRead, Interactive}},
+      {"textDocument/declaration", {DocumentRead, Interactive}},
+      {"textDocument/typeDefinition", {DocumentRead, Interactive}},
+      {"textDocument/implementation", {DocumentRead, Interactive}},
+
+      {"textDocument/documentHighlight", {DocumentRead, VisibleRange}},
+      {"textDocument/semanticTokens/range", {DocumentRead, VisibleRange}},
+      {"textDocument/inlayHint", {DocumentRead, VisibleRange}},
+      {"textDocument/codeLens", {DocumentRead, VisibleRange}},
+      {"textDocument/documentLink", {DocumentRead, VisibleRange}},
+
+      {"textDocument/semanticTokens/full", {DocumentRead, Background}},
+      {"textDocument/semanticTokens/full/delta", {DocumentRead, Background}},
+      {"textDocument/diagnostic", {DocumentRead, Background}},
+      {"textDocument/documentSymbol", {DocumentRead, Background}},
+      {"textDocument/foldingRange", {DocumentRead, Background}},
+      {"textDocument/references", {DocumentRead, Background}},
+  };
+
+  if (auto it = policies.find(method); it != policies.end()) {
+    return it->second;
+  }
+
+  if (method.starts_with("textDocument/")) {
+    return {DocumentRead, Interactive};
+  }
+
+  return {Barrier, Interactive};
+}
+
+struct DocumentTarget {
+  std::string m_uri;
+  std::optional<int64_t> m_version;
+};
+
+/// Pull `params.textDocument.{uri,version}` out of a message without materializing its DOM.
+static auto GetDocumentTarget(const Message& message) -> std::optional<DocumentTarget> {
+  std::optional<std::string> uri;
+  std::optional<int64_t> version;
+
+  if (const auto raw = message.GetRawJson(); !raw.empty()) {
+    JsonScanner scanner(raw);
+    const auto ok = scanner.ReadObject([&](std::string_view key, JsonScanner& value) {
+      if (key != "textDocument" || value.Peek() != '{') {
+        return value.SkipValue();
+      }
+
+      return value.ReadObject([&](std::string_view key, JsonScanner& value) {
+        if (key == "uri" && value.Peek() == '"') {
+          return value.ReadString(uri.emplace());
+        }
+
+        if (key == "version" && value.Peek() != 'n') {
+          return value.ReadInteger(version.emplace());
+        }
+
+        return value.SkipValue();
+      });
+    });
+
+    if (!ok) {
+      return std::nullopt;
+    }
+  } else if (const auto& params = *message; params.is_object() && params.contains("textDocument")) {
+    const auto& text_document = params["textDocument"];
+    if (text_document.is_object() && text_document.contains("uri") && text_document["uri"].is_string()) {
+      uri = text_document["uri"].get<std::string>();
+    }
+
+    if (text_document.is_object() && text_document.contains("version") &&
+        text_document["version"].is_number_integer()) {
+      version = text_document["version"].get<int64_t>();
+    }
+  }
+
+  if (!uri.has_value()) {
+    return std::nullopt;
+  }
+
+  return DocumentTarget{.m_uri = std::move(*uri), .m_version = version};
+}
+
 class Scheduler::PImpl {
 public:
   std::optional<ThreadPool> m_thread_pool;
   std::atomic<bool> m_exit_requested = false;
 
   Context m_context;
-  std::mutex m_fruition;
 
-  PImpl(std::ostream& os, std::mutex& os_lock) : m_context(os, os_lock) {}
+  std::mutex m_mutex;
+  std::condition_variable m_idle;
+  std::unordered_map<std::string_view, std::unique_ptr<Strand>> m_strands;
+  /// Messages handed to the pool or waiting on a strand that have not finished yet.
+  size_t m_outstanding = 0;
+  /// Requests that `$/cancelRequest` can still reach, keyed by request id.
+  std::unordered_map<MessageSequenceID, std::stop_source> m_cancellable;
+
+  struct ReadyItem {
+    Task m_run;
+    std::chrono::steady_clock::time_point m_enqueued;
+    bool m_is_request;
+  };
+
+  /// Work that may start now, by priority. The pool only sees one "run the best ready item" token per item.
+  std::array<std::deque<ReadyItem>, kPriorityCount> m_ready;
+  size_t m_background_running = 0;
+  size_t m_background_limit = std::max(std::jthread::hardware_concurrency() / 2, 1U);
+
+  /// Requests accepted but not yet started, by priority; what the queue limits bound. Notifications are not
+  /// counted, so a burst of edits can not use up the room meant for the requests that follow it.
+  std::array<size_t, kPriorityCount> m_queued{};
+
+  /// How long an item may wait before it is served ahead of higher priorities.
+  static constexpr std::array<std::chrono::milliseconds, kPriorityCount> kAgingThresholds = {
+      std::chrono::milliseconds(0),
+      std::chrono::milliseconds(100),
+      std::chrono::milliseconds(500),
+  };
+
+  PImpl(MessageWriter& writer) : m_context(writer) {}
 
-  static auto IsConcurrentRequest(const message::Message& message) -> bool {
-    static const std::unordered_set<std::string_view> parallelizable_messages = {
-        ///========================================================================
-        /// BEGIN: LSP Lifecycle messages
-        "$/setTrace",
+  /// Queue work at the given priority. Requires `m_mutex`.
+  void Submit(Priority priority, bool is_request, Task run) {
+    m_ready[static_cast<size_t>(priority)].push_back({
+        .m_run = std::move(run),
+        .m_enqueued = std::chrono::steady_clock::now(),
+        .m_is_request = is_request,
+    });
+
+    m_thread_pool->Schedule([this](const std::stop_token& st) { RunNextReady(st); });
+  }
 
-        ///========================================================================
-        /// BEGIN: LSP Document Synchronization messages
+  /// Requires `m_mutex`.
+  auto PickReady() -> std::optional<std::pair<Priority, ReadyItem>> {
+    const auto now = std::chrono::steady_clock::now();
+    const auto background_allowed = m_background_running < m_background_limit;
 
-        ///========================================================================
-        /// BEGIN: LSP Feature messages
-        "textDocument/completion",
+    const auto take = [&](Priority priority) {
+      auto& queue = m_ready[static_cast<size_t>(priority)];
+      auto item = std::move(queue.front());
+      queue.pop_front();
+
+      return std::make_pair(priority, std::move(item));
     };
 
-    return parallelizable_messages.contains(message.GetMethod());
+    // Aging: lower priorities that have waited long enough jump the queue
+    for (auto priority : {Priority::Background, Priority::VisibleRange}) {
+      const auto& queue = m_ready[static_cast<size_t>(priority)];
+      if (queue.empty() || (priority == Priority::Background && !background_allowed)) {
+        continue;
+      }
+
+      if (now - queue.front().m_enqueued >= kAgingThresholds[static_cast<size_t>(priority)]) {
+        return take(priority);
+      }
+    }
+
+    for (auto priority : {Priority::Interactive, Priority::VisibleRange, Priority::Background}) {
+      if (m_ready[static_cast<size_t>(priority)].empty() ||
+          (priority == Priority::Background && !background_allowed)) {
+        continue;
+      }
+
+      return take(priority);
+    }
+
+    return std::nullopt;
+  }
+
+  void RunNextReady(const std::stop_token& st) {
+    std::unique_lock lock(m_mutex);
+
+    auto next = PickReady();
+    if (!next.has_value()) {
+      // Only capped background work is left; a finishing background item will come back for it
+      return;
+    }
+
+    auto& [priority, item] = *next;
+    if (item.m_is_request) {
+      --m_queued[static_cast<size_t>(priority)];
+    }
+
+    const auto is_background = priority == Priority::Background;
+    if (is_background) {
+      ++m_background_running;
+    }
+
+    lock.unlock();
+    item.m_run(st);
+
+    if (is_background) {
+      lock.lock();
+      --m_background_running;
+
+      if (!m_ready[static_cast<size_t>(Priority::Background)].empty()) {
+        m_thread_pool->Schedule([this](const std::stop_token& st) { RunNextReady(st); });
+      }
+    }
+  }
+
+  void Execute(const Message& message, std::chrono::steady_clock::time_point scheduled_at) {
+    auto& metrics = m_context.GetMetrics();
+    const auto started_at = std::chrono::steady_clock::now();
+    metrics.OnDequeued(message.GetMethod(), started_at - scheduled_at);
+    metrics.OnWorkerBusy();
+
+    bool exit_requested = false;
+    m_context.ExecuteRPC(message, exit_requested);
+    m_exit_requested = exit_requested || m_exit_requested;
+
+    metrics.OnWorkerIdle(std::chrono::steady_clock::now() - started_at);
+  }
+
+  void WaitForIdle() {
+    std::unique_lock lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_outstanding == 0; });
+  }
+
+  /// Account for a message that will run on the pool. Requires `m_mutex`.
+  void OnScheduled(Message& message) {
+    ++m_outstanding;
+
+    if (message.IsRequest()) {
+      auto& request = static_cast<RequestMessage&>(message);
+
+      std::stop_source source;
+      request.SetStopToken(source.get_token());
+      m_cancellable.insert_or_assign(request.GetRequestID(), std::move(source));
+    }
+  }
+
+  void OnFinished(const Message& message, std::unique_lock<std::mutex>& lock) {
+    qcore_assert(lock.owns_lock());
+
+    if (message.IsRequest()) {
+      m_cancellable.erase(static_cast<const RequestMessage&>(message).GetRequestID());
+    }
+
+    if (--m_outstanding == 0) {
+      lock.unlock();
+      m_idle.notify_all();
+    }
+  }
+
+  void Cancel(const Message& notice) {
+    std::optional<MessageSequenceID> id;
+
+    if (const auto raw = notice.GetRawJson(); !raw.empty()) {
+      JsonScanner scanner(raw);
+      const auto ok = scanner.ReadObject([&](std::string_view key, JsonScanner& value) {
+        if (key != "id") {
+          return value.SkipValue();
+        }
+
+        if (value.Peek() == '"') {
+          return value.ReadString(std::get<std::string>(id.emplace(std::string())));
+        }
+
+        return value.ReadInteger(std::get<int64_t>(id.emplace(int64_t(0))));
+      });
+
+      if (!ok) {
+        id.reset();
+      }
+    } else if (const auto& params = *notice; params.is_object() && params.contains("id")) {
+      if (params["id"].is_number_integer()) {
+        id = params["id"].get<int64_t>();
+      } else if (params["id"].is_string()) {
+        id = params["id"].get<std::string>();
+      }
+    }
+
+    if (!id.has_value()) [[unlikely]] {
+      Log << "Invalid $/cancelRequest notification";
+      return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    if (auto it = m_cancellable.find(*id); it != m_cancellable.end()) {
+      Log << Debug << "Scheduler: Cancelling request";
+      it->second.request_stop();
+    } else {
+      Log << Debug << "Scheduler: Request to cancel has already finished";
+    }
+  }
+
+  /// Requires `m_mutex`.
+  void RunConcurrent(Priority priority, std::unique_ptr<Message> message) {
+    const auto is_request = message->IsRequest();
+    if (is_request) {
+      ++m_queued[static_cast<size_t>(priority)];
+    }
+
+    const auto scheduled_at = std::chrono::steady_clock::now();
+
+    Submit(priority, is_request, [this, scheduled_at, message = std::move(message)](const std::stop_token&) {
+      Execute(*message, scheduled_at);
+
+      std::unique_lock lock(m_mutex);
+      OnFinished(*message, lock);
+    });
+  }
+
+  /// Start every item at the head of the strand that may run now. Requires `m_mutex`.
+  void Pump(Strand& strand) {
+    while (!strand.m_queue.empty() && !strand.m_active_writer) {
+      auto& head = strand.m_queue.front();
+      if (head.m_is_write && strand.m_active_readers != 0) {
+        break;
+      }
+
+      const auto is_write = head.m_is_write;
+      const auto priority = head.m_priority;
+      const auto scheduled_at = head.m_scheduled_at;
+      const auto is_request = head.m_message->IsRequest();
+      auto message = std::move(head.m_message);
+      strand.m_queue.pop_front();
+
+      if (is_write) {
+        strand.m_active_writer = true;
+      } else {
+        ++strand.m_active_readers;
+      }
+
+      auto task = [this, &strand, is_write, scheduled_at, message = std::move(message)](const std::stop_token&) {
+        Execute(*message, scheduled_at);
+
+        std::unique_lock lock(m_mutex);
+        if (is_write) {
+          strand.m_active_writer = false;
+        } else {
+          --strand.m_active_readers;
+        }
+
+        Pump(strand);
+
+        if (strand.m_queue.empty() && !strand.m_active_writer && strand.m_active_readers == 0) {
+          m_strands.erase(m_strands.find(strand.m_uri));
+        }
+
+        OnFinished(*message, lock);
+      };
+
+      Submit(priority, is_request, std::move(task));
+    }
+  }
+
+  /// Answer a request without running it, and forget the message. Requires `m_mutex`.
+  void Reject(std::unique_ptr<Message> message, StatusCode code, std::string_view reason,
+              std::vector<ResponseMessage>& responses) {
+    if (message->IsRequest()) {
+      auto response = static_cast<const RequestMessage&>(*message).GetResponseObject();
+      *response = {{"message", reason}};
+      response.SetStatusCode(code);
+      responses.push_back(std::move(response));
+
+      m_cancellable.erase(static_cast<const RequestMessage&>(*message).GetRequestID());
+    }
+
+    if (--m_outstanding == 0) {
+      m_idle.notify_all();
+    }
+  }
+
+  /// Whether another request of this class may queue up. Requires `m_mutex`.
+  [[nodiscard]] auto HasQueueRoom(Priority priority) const -> bool {
+    const auto& limits = m_context.GetQueueLimits();
+
+    switch (priority) {
+      case Priority::Interactive:
+        return m_queued[static_cast<size_t>(priority)] < limits.m_interactive;
+      case Priority::VisibleRange:
+        return m_queued[static_cast<size_t>(priority)] < limits.m_visible_range;
+      case Priority::Background:
+        return m_queued[static_cast<size_t>(priority)] < limits.m_background;
+    }
+
+    return true;
+  }
+
+  /// Replace a queued read identical to `message` (same method and params) in place. Requires `m_mutex`.
+  auto Collapse(Strand& strand, std::unique_ptr<Message>& message, std::vector<ResponseMessage>& responses) -> bool {
+    const auto raw = message->GetRawJson();
+    if (!message->IsRequest() || raw.empty()) {
+      return false;
+    }
+
+    // Only reads queued after the last write; moving the newer request ahead of a write would let it see stale content
+    for (auto it = strand.m_queue.rbegin(); it != strand.m_queue.rend() && !it->m_is_write; ++it) {
+      auto& item = *it;
+      if (!item.m_message->IsRequest() || item.m_message->GetMethod() != message->GetMethod() ||
+          item.m_message->GetRawJson() != raw) {
+        continue;
+      }
+
+      // The newer request keeps the older one's place in line; the client has moved on from the older one
+      std::swap(item.m_message, message);
+      item.m_scheduled_at = std::chrono::steady_clock::now();
+      m_context.GetMetrics().OnCollapsed(message->GetMethod());
+      Reject(std::move(message), StatusCode::ServerCancelled, "Superseded by an identical request", responses);
+
+      return true;
+    }
+
+    return false;
+  }
+
+  void RunOnStrand(DocumentTarget target, bool is_write, Priority priority, std::unique_ptr<Message> message) {
+    std::vector<ResponseMessage> rejected;
+
+    {
+      std::lock_guard lock(m_mutex);
+
+      auto it = m_strands.find(target.m_uri);
+      if (it == m_strands.end()) {
+        auto strand = std::make_unique<Strand>();
+        strand->m_uri = std::move(target.m_uri);
+        it = m_strands.emplace(strand->m_uri, std::move(strand)).first;
+      }
+
+      auto& strand = *it->second;
+
+      if (is_write && target.m_version.has_value()) {
+        // Reads still waiting for their turn were computed against an older version
+        const auto is_current = [&](const Strand::Item& item) {
+          return item.m_is_write || !item.m_version.has_value() || *item.m_version >= *target.m_version;
+        };
+
+        const auto stale = std::stable_partition(strand.m_queue.begin(), strand.m_queue.end(), is_current);
+        for (auto item = stale; item != strand.m_queue.end(); ++item) {
+          if (item->m_message->IsRequest()) {
+            --m_queued[static_cast<size_t>(item->m_priority)];
+          }
+
+          m_context.GetMetrics().OnDropped(item->m_message->GetMethod());
+          Reject(std::move(item->m_message), StatusCode::ContentModified, "Content modified", rejected);
+        }
+
+        strand.m_queue.erase(stale, strand.m_queue.end());
+
+        strand.m_version = target.m_version;
+      }
+
+      if (is_write || (!Collapse(strand, message, rejected) && !TryShed(message, priority, rejected))) {
+        const auto version = is_write ? target.m_version : strand.m_version;
+        if (message->IsRequest()) {
+          ++m_queued[static_cast<size_t>(priority)];
+        }
+
+        strand.m_queue.push_back({
+            .m_message = std::move(message),
+            .m_is_write = is_write,
+            .m_priority = priority,
+            .m_scheduled_at = std::chrono::steady_clock::now(),
+            .m_version = version,
+        });
+        Pump(strand);
+      } else if (strand.m_queue.empty() && !strand.m_active_writer && strand.m_active_readers == 0) {
+        m_strands.erase(it);
+      }
+    }
+
+    SendRejections(rejected);
+  }
+
+  void SendRejections(std::vector<ResponseMessage>& responses) {
+    for (auto& response : responses) {
+      Log << Debug << "Scheduler: Answering request without running it";
+      m_context.SendMessage(response);
+    }
+  }
+
+  /// Refuse a request whose class is over its queue limit. Notifications carry state and are never shed.
+  /// Requires `m_mutex`.
+  auto TryShed(std::unique_ptr<Message>& message, Priority priority, std::vector<ResponseMessage>& responses) -> bool {
+    if (!message->IsRequest() || HasQueueRoom(priority)) {
+      return false;
+    }
+
+    m_context.GetMetrics().OnShed(message->GetMethod());
+    Reject(std::move(message), StatusCode::ServerCancelled, "Server overloaded", responses);
+
+    return true;
   }
 };
 
 void Scheduler::Schedule(std::unique_ptr<Message> request) {
   qcore_assert(m_pimpl != nullptr);
+  NO3_TRACE_SPAN("lsp", "Scheduler::Schedule");
 
   auto& m = *m_pimpl;
 
@@ -89,39 +631,72 @@ void Scheduler::Schedule(std::unique_ptr<Message> request) {
 
       m.m_thread_pool.emplace();
       m.m_thread_pool->Start();
+      m.m_context.GetMetrics().SetWorkerCount(m.m_thread_pool->GetThreadCount());
     }
   }
 
-  const auto method = request->GetMethod();
+  const auto method = std::string(request->GetMethod());
 
-  if (PImpl::IsConcurrentRequest(*request)) {
-    std::lock_guard lock(m.m_fruition);
+  // Must not queue behind the request it is meant to cancel
+  if (method == "$/cancelRequest") {
+    m.Cancel(*request);
+    return;
+  }
 
-    Log << Trace << "Scheduler: Scheduler::Schedule(\"" << method << "\"): Scheduling concurrent request";
+  auto [ordering, priority] = GetPolicy(method);
+  const auto scheduled_at = std::chrono::steady_clock::now();
+  m.m_context.GetMetrics().OnEnqueued();
 
-    const auto sh = std::make_shared<std::unique_ptr<Message>>(std::move(request));
-    m.m_thread_pool->Schedule([this, sh](const std::stop_token&) {
-      auto& m = *m_pimpl;
+  std::optional<DocumentTarget> target;
+  if (ordering == Ordering::DocumentRead || ordering == Ordering::DocumentWrite) {
+    target = GetDocumentTarget(*request);
+    if (!target.has_value()) [[unlikely]] {
+      // Let the handler report the malformed message, without racing anything else
+      ordering = Ordering::Barrier;
+    }
+  }
 
-      bool exit_requested = false;
-      m.m_context.ExecuteRPC(**sh, exit_requested);
-      m.m_exit_requested = exit_requested || m.m_exit_requested;
-    });
+  switch (ordering) {
+    case Ordering::Barrier: {
+      Log << Trace << "Scheduler: Scheduler::Schedule(\"" << method << "\"): Waiting for in-flight messages";
 
-    return;
-  }
+      // Shall block the primary thread
+      m.WaitForIdle();
+      m.Execute(*request, scheduled_at);
+      break;
+    }
+
+    case Ordering::Concurrent: {
+      Log << Trace << "Scheduler: Scheduler::Schedule(\"" << method << "\"): Scheduling concurrent request";
 
-  Log << Trace << "Scheduler: Scheduler::Schedule(\"" << method << "\"): Concurrency disallowed";
+      std::vector<ResponseMessage> rejected;
 
-  {  // Shall block the primary thread
-    std::lock_guard lock(m.m_fruition);
-    while (!m.m_thread_pool->Empty()) {
-      std::this_thread::yield();
+      {
+        std::lock_guard lock(m.m_mutex);
+        m.OnScheduled(*request);
+        if (!m.TryShed(request, priority, rejected)) {
+          m.RunConcurrent(priority, std::move(request));
+        }
+      }
+
+      m.SendRejections(rejected);
+      break;
     }
 
-    bool exit_requested = false;
-    m.m_context.ExecuteRPC(*request, exit_requested);
-    m.m_exit_requested = exit_requested || m.m_exit_requested;
+    case Ordering::DocumentRead:
+    case Ordering::DocumentWrite: {
+      const auto is_write = ordering == Ordering::DocumentWrite;
+      Log << Trace << "Scheduler: Scheduler::Schedule(\"" << method << "\"): Scheduling document "
+          << (is_write ? "write" : "read") << " on " << target->m_uri;
+
+      {
+        std::lock_guard lock(m.m_mutex);
+        m.OnScheduled(*request);
+      }
+
+      m.RunOnStrand(std::move(*target), is_write, priority, std::move(request));
+      break;
+    }
   }
 }
 
@@ -130,6 +705,12 @@ bool Scheduler::IsExitRequested() const {
   return m_pimpl->m_exit_requested;
 }
 
-Scheduler::Scheduler(std::ostream& os, std::mutex& os_lock) : m_pimpl(std::make_unique<PImpl>(os, os_lock)) {}
+Scheduler::Scheduler(MessageWriter& writer) : m_pimpl(std::make_unique<PImpl>(writer)) {}
 
-Scheduler::~Scheduler() = default;
+Scheduler::~Scheduler() {
+  if (m_pimpl != nullptr) {
+    // In-flight messages reference the context, which is destroyed before the pool
+    m_pimpl->WaitForIdle();
+    m_pimpl->m_thread_pool.reset();
+  }
+}
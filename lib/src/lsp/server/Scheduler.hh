@@ -36,7 +36,6 @@
 #include <lsp/protocol/Message.hh>
 #include <lsp/server/Context.hh>
 #include <lsp/server/ThreadPool.hh>
-#include <ostream>
 
 namespace no3::lsp::core {
   class Scheduler {
@@ -44,7 +43,7 @@ namespace no3::lsp::core {
     std::unique_ptr<PImpl> m_pimpl;
 
   public:
-    Scheduler(std::ostream& os, std::mutex& os_lock);
+    Scheduler(MessageWriter& writer);
     Scheduler(const Scheduler&) = delete;
     Scheduler(Scheduler&&) = default;
     ~Scheduler();
@@ -31,8 +31,15 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <fcntl.h>
+
+#include <condition_variable>
+#include <lsp/connect/FileDescriptorStream.hh>
+#include <lsp/server/BoundedQueue.hh>
+#include <lsp/server/MessageWriter.hh>
 #include <lsp/server/Scheduler.hh>
 #include <lsp/server/Server.hh>
+#include <lsp/server/SessionTag.hh>
 #include <lsp/server/ThreadPool.hh>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
@@ -41,81 +48,182 @@ using namespace ncc;
 using namespace no3::lsp::core;
 using namespace no3::lsp::message;
 
+static constexpr size_t kMaxFailedRequestCount = 3;
+static constexpr size_t kInboxCapacity = 256;
+
+/// Read through a private duplicate of the input descriptor, so that a reader detached at shutdown never
+/// touches the caller's stream. Returns null for streams that are not backed by a descriptor.
+static auto DuplicateInput(std::istream& in) -> std::unique_ptr<FileDescriptorStream> {
+  auto* fd_buf = dynamic_cast<FileDescriptorStreamBuf*>(in.rdbuf());
+  if (fd_buf == nullptr || fd_buf->GetInputDescriptor() < 0) {
+    return nullptr;
+  }
+
+  const auto fd = fcntl(fd_buf->GetInputDescriptor(), F_DUPFD_CLOEXEC, 0);
+  if (fd < 0) [[unlikely]] {
+    Log << "Server: Failed to duplicate the input descriptor";
+    return nullptr;
+  }
+
+  return std::make_unique<FileDescriptorStream>(std::make_unique<FileDescriptorStreamBuf>(fd, -1, true));
+}
+
+/// State shared with the reader thread. It may outlive the server if the reader is
+/// still blocked on the input stream when the server shuts down, so it owns everything
+/// the reader touches.
+struct Server::ReaderState {
+  std::unique_ptr<FileDescriptorStream> m_owned_input;
+  FrameDecoder m_decoder;
+  DeflateDecompressor m_inflater;
+  std::mutex m_is_mutex;
+  BoundedQueue<std::unique_ptr<Message>> m_inbox;
+  std::atomic<bool> m_finished = false;
+
+  ReaderState(std::istream& in)
+      : m_owned_input(DuplicateInput(in)),
+        m_decoder(m_owned_input != nullptr ? *m_owned_input : in),
+        m_inbox(kInboxCapacity) {}
+};
+
 class Server::PImpl {
 public:
   State m_state = State::Suspended;
   std::mutex m_state_mutex;
+  std::condition_variable m_state_cv;
   std::iostream& m_io;
-  std::mutex m_is_mutex;
-  std::mutex m_os_mutex;
+  MessageWriter m_writer;
   Scheduler m_request_scheduler;
+  std::shared_ptr<ReaderState> m_reader_state;
+  std::jthread m_reader;
+
+  PImpl(std::iostream& io)
+      : m_io(io), m_writer(io), m_request_scheduler(m_writer), m_reader_state(std::make_shared<ReaderState>(io)) {}
+
+  ~PImpl() {
+    m_reader_state->m_inbox.Close();
+
+    if (m_reader.joinable() && !m_reader_state->m_finished) {
+      auto& owned_input = m_reader_state->m_owned_input;
+
+      if (owned_input == nullptr) {
+        // Not backed by a descriptor; such streams must not block indefinitely, and the reader borrows them.
+        Log << Trace << "Server: ~PImpl(): Joining reader thread";
+        m_reader.join();
+      } else if (owned_input->GetStreamBuf().ShutdownInput()) {
+        Log << Trace << "Server: ~PImpl(): Interrupted blocked reader thread";
+        m_reader.join();
+      } else {
+        // The reader is blocked on a pipe or terminal and can not be interrupted. It only touches
+        // its own descriptor and the shared state, both of which it keeps alive.
+        Log << Trace << "Server: ~PImpl(): Detaching blocked reader thread";
+        m_reader.detach();
+      }
+    }
+  }
+
+  void SetState(State state) {
+    {
+      std::lock_guard lock(m_state_mutex);
+      m_state = state;
+    }
 
-  PImpl(std::iostream& io) : m_io(io), m_request_scheduler(io, m_os_mutex) {}
+    m_state_cv.notify_all();
+  }
 };
 
 Server::Server(std::iostream& io) : m_pimpl(std::make_unique<PImpl>(io)) {}
 
 Server::~Server() = default;
 
-auto Server::Start() -> bool {
-  qcore_assert(m_pimpl != nullptr);
-
-  {
-    std::lock_guard lock(m_pimpl->m_state_mutex);
-    Log << Trace << "Server: Start(): State::Suspended -> State::Running";
-    m_pimpl->m_state = State::Running;
-  }
+void Server::ReaderLoop(const std::stop_token& st, const std::shared_ptr<ReaderState>& state) {
+  Log << Trace << "Server: ReaderLoop(): Started";
 
-  constexpr size_t kMaxFailedRequestCount = 3;
   size_t sucessive_failed_request_count = 0;
 
-  while (true) {
-    std::lock_guard lock(m_pimpl->m_state_mutex);
+  while (!st.stop_requested()) {
+    auto request = ReadRequest(state->m_decoder, state->m_inflater, state->m_is_mutex);
+    if (!request.has_value()) [[unlikely]] {
+      if (state->m_decoder.IsEOF()) {
+        Log << "Server: ReaderLoop(): End of input stream";
+        break;
+      }
+
+      sucessive_failed_request_count++;
+      Log << "Server: ReaderLoop(): ReadRequest() failed";
 
-    switch (auto current_state = m_pimpl->m_state) {
-      case State::Suspended: {
-        // Minimize CPU usage while waiting for the server to be resumed
-        std::this_thread::sleep_for(std::chrono::milliseconds(32));
+      if (sucessive_failed_request_count > kMaxFailedRequestCount) {
+        Log << "Server: ReaderLoop(): Too many successive invalid requests (max: " << kMaxFailedRequestCount
+            << "). Exiting.";
         break;
       }
 
-      case State::Running: {
-        auto request = ReadRequest(m_pimpl->m_io, m_pimpl->m_is_mutex);
-        if (!request.has_value()) [[unlikely]] {
-          sucessive_failed_request_count++;
-          Log << "Server: Start(): ReadRequest() failed";
+      continue;
+    }
+
+    sucessive_failed_request_count = 0;
+
+    if (!state->m_inbox.Push(std::move(request.value()))) {
+      break;
+    }
+  }
+
+  state->m_inbox.Close();
+  state->m_finished = true;
 
-          if (sucessive_failed_request_count > kMaxFailedRequestCount) {
-            Log << "Server: Start(): Too many successive invalid requests (max: " << kMaxFailedRequestCount
-                << "). Exiting.";
-            Log << Trace << "Server: Start(): State::Running -> State::Exited";
-            m_pimpl->m_state = State::Exited;
-            break;
-          }
+  Log << Trace << "Server: ReaderLoop(): Stopped";
+}
 
-          break;
-        }
+auto Server::Start() -> bool {
+  qcore_assert(m_pimpl != nullptr);
 
-        sucessive_failed_request_count = 0;
+  auto& m = *m_pimpl;
 
-        auto& scheduler = m_pimpl->m_request_scheduler;
-        scheduler.Schedule(std::move(request.value()));
+  m.SetState(State::Running);
+  Log << Trace << "Server: Start(): State::Suspended -> State::Running";
 
-        if (scheduler.IsExitRequested()) [[unlikely]] {
-          Log << Trace << "Server: Start(): Exit requested";
-          Log << Trace << "Server: Start(): State::Running -> State::Exited";
-          m_pimpl->m_state = State::Exited;
-          break;
-        }
+  m.m_reader = std::jthread([state = m.m_reader_state, parent_thread_logger = Log,
+                             session_tag = GetThreadSessionTag()](const std::stop_token& st) {
+    // Use the logger and session of the parent thread
+    Log = parent_thread_logger;
+    SetThreadSessionTag(session_tag);
+    ReaderLoop(st, state);
+  });
 
+  auto& scheduler = m.m_request_scheduler;
+
+  while (true) {
+    auto request = m.m_reader_state->m_inbox.Pop();
+
+    {  // Park while suspended
+      std::unique_lock lock(m.m_state_mutex);
+      m.m_state_cv.wait(lock, [&m] { return m.m_state != State::Suspended; });
+
+      if (m.m_state == State::Exited) {
         break;
       }
 
-      case State::Exited: {
-        return true;
+      if (!request.has_value()) [[unlikely]] {
+        Log << Trace << "Server: Start(): Reader finished";
+        Log << Trace << "Server: Start(): State::Running -> State::Exited";
+        m.m_state = State::Exited;
+        break;
       }
     }
+
+    scheduler.Schedule(std::move(request.value()));
+
+    if (scheduler.IsExitRequested()) [[unlikely]] {
+      Log << Trace << "Server: Start(): Exit requested";
+      Log << Trace << "Server: Start(): State::Running -> State::Exited";
+      m.SetState(State::Exited);
+      break;
+    }
   }
+
+  m.m_reader.request_stop();
+  m.m_reader_state->m_inbox.Close();
+
+  return true;
 }
 
 auto Server::Suspend() -> bool {
@@ -150,6 +258,7 @@ auto Server::Resume() -> bool {
     case State::Suspended: {
       Log << Trace << "Server: Resume(): State::Suspended -> State::Running";
       m_pimpl->m_state = State::Running;
+      m_pimpl->m_state_cv.notify_all();
       return true;
     }
 
@@ -170,6 +279,10 @@ auto Server::Stop() -> bool {
   qcore_assert(m_pimpl != nullptr);
   std::lock_guard lock(m_pimpl->m_state_mutex);
 
+  // Wake the dispatcher if it is waiting for the next request
+  m_pimpl->m_reader_state->m_inbox.Close();
+  m_pimpl->m_state_cv.notify_all();
+
   switch (auto current_state = m_pimpl->m_state) {
     case State::Suspended: {
       Log << Trace << "Server: Stop(): State::Suspended -> State::Exited";
@@ -35,17 +35,25 @@
 
 #include <iostream>
 #include <lsp/protocol/Message.hh>
+#include <lsp/server/ContentEncoding.hh>
+#include <lsp/server/FrameDecoder.hh>
 #include <lsp/server/ThreadPool.hh>
 #include <optional>
+#include <stop_token>
 
 namespace no3::lsp::core {
   class Server {
     class PImpl;
+    struct ReaderState;
     std::unique_ptr<PImpl> m_pimpl;
 
-    auto ReadRequest(std::istream& in, std::mutex& in_lock) -> std::optional<std::unique_ptr<message::Message>>;
+    static auto ReadRequest(FrameDecoder& in, DeflateDecompressor& inflater,
+                            std::mutex& in_lock) -> std::optional<std::unique_ptr<message::Message>>;
+    static void ReaderLoop(const std::stop_token& st, const std::shared_ptr<ReaderState>& state);
 
   public:
+    /// `io` must outlive the server. Input on a descriptor-backed stream is read through a duplicate
+    /// descriptor; any other stream is borrowed, and must not block once its source is done.
     Server(std::iostream& io);
     ~Server();
 
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Move-only `void(std::stop_token)` callable. Callables of up to
+ * `kInlineSize` bytes (which covers every lambda the scheduler submits) are
+ * stored in place, so wrapping one never touches the heap.
+ */
+class Task final {
+public:
+  static constexpr size_t kInlineSize = 48;
+
+  Task() = default;
+
+  template <typename Fn>
+    requires(!std::same_as<std::decay_t<Fn>, Task> && std::invocable<std::decay_t<Fn>&, std::stop_token>)
+  Task(Fn&& fn) {  // NOLINT(google-explicit-constructor)
+    using Callable = std::decay_t<Fn>;
+
+    if constexpr (IsInline<Callable>) {
+      ::new (static_cast<void*>(m_storage)) Callable(std::forward<Fn>(fn));
+      m_vtable = &kInlineVTable<Callable>;
+    } else {
+      ::new (static_cast<void*>(m_storage)) Callable*(new Callable(std::forward<Fn>(fn)));
+      m_vtable = &kHeapVTable<Callable>;
+    }
+  }
+
+  Task(const Task&) = delete;
+  Task(Task&& other) noexcept { MoveFrom(other); }
+
+  auto operator=(const Task&) -> Task& = delete;
+  auto operator=(Task&& other) noexcept -> Task& {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+
+    return *this;
+  }
+
+  ~Task() { Reset(); }
+
+  void operator()(std::stop_token st) { m_vtable->m_invoke(m_storage, std::move(st)); }
+
+  explicit operator bool() const { return m_vtable != nullptr; }
+
+  void Reset() {
+    if (m_vtable != nullptr) {
+      m_vtable->m_destroy(m_storage);
+      m_vtable = nullptr;
+    }
+  }
+
+private:
+  struct VTable {
+    void (*m_invoke)(void* storage, std::stop_token st);
+    void (*m_move)(void* dst, void* src) noexcept;
+    void (*m_destroy)(void* storage) noexcept;
+  };
+
+  template <typename Callable>
+  static constexpr bool IsInline = sizeof(Callable) <= kInlineSize && alignof(Callable) <= alignof(std::max_align_t) &&
+                                   std::is_nothrow_move_constructible_v<Callable>;
+
+  template <typename Callable>
+  static constexpr VTable kInlineVTable = {
+      .m_invoke = [](void* storage, std::stop_token st) { (*static_cast<Callable*>(storage))(std::move(st)); },
+      .m_move =
+          [](void* dst, void* src) noexcept {
+            auto* from = static_cast<Callable*>(src);
+            ::new (dst) Callable(std::move(*from));
+            from->~Callable();
+          },
+      .m_destroy = [](void* storage) noexcept { static_cast<Callable*>(storage)->~Callable(); },
+  };
+
+  template <typename Callable>
+  static constexpr VTable kHeapVTable = {
+      .m_invoke = [](void* storage, std::stop_token st) { (**static_cast<Callable**>(storage))(std::move(st)); },
+      .m_move = [](void* dst, void* src) noexcept { ::new (dst) Callable*(*static_cast<Callable**>(src)); },
+      .m_destroy = [](void* storage) noexcept { delete *static_cast<Callable**>(storage); },
+  };
+
+  void MoveFrom(Task& other) noexcept {
+    if (other.m_vtable != nullptr) {
+      other.m_vtable->m_move(m_storage, other.m_storage);
+      m_vtable = std::exchange(other.m_vtable, nullptr);
+    }
+  }
+
+  alignas(std::max_align_t) std::byte m_storage[kInlineSize];
+  const VTable* m_vtable = nullptr;
+};
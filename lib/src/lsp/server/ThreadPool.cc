@@ -31,85 +31,255 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <chrono>
+#include <lsp/server/SessionTag.hh>
 #include <lsp/server/ThreadPool.hh>
 #include <mutex>
 #include <nitrate-core/Logger.hh>
 #include <nitrate-core/SmartLock.hh>
 #include <stop_token>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 using namespace ncc;
+using namespace no3::lsp::core;
+
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+namespace {
+  struct WorkerIdentity {
+    const ThreadPool* m_pool = nullptr;
+    size_t m_index = 0;
+  };
+
+  /// Recycles the nodes that worker deques hold, so worker-local scheduling does not allocate.
+  class TaskNodeCache final {
+    static constexpr size_t kMaxCachedNodes = 1024;
+    std::vector<Task*> m_free;
+
+  public:
+    ~TaskNodeCache() {
+      for (auto* node : m_free) {
+        delete node;
+      }
+    }
+
+    auto Acquire(Task&& job) -> Task* {
+      if (m_free.empty()) {
+        return new Task(std::move(job));
+      }
+
+      auto* node = m_free.back();
+      m_free.pop_back();
+      *node = std::move(job);
+
+      return node;
+    }
+
+    void Release(Task* node) {
+      node->Reset();
+
+      if (m_free.size() < kMaxCachedNodes) {
+        m_free.push_back(node);
+      } else {
+        delete node;
+      }
+    }
+  };
+}  // namespace
+
+static thread_local WorkerIdentity CURRENT_WORKER;
+static thread_local TaskNodeCache TASK_NODES;
 
-void ThreadPool::Start() {
-  auto optimal_thread_count = std::max(std::jthread::hardware_concurrency(), 1U);
+static auto NextVictimSeed() -> uint32_t {
+  static thread_local uint32_t state = std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1;
+
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+
+  return state;
+}
+
+void ThreadPool::Start(size_t thread_count) {
+  auto optimal_thread_count = thread_count != 0 ? thread_count : std::max(std::jthread::hardware_concurrency(), 1U);
   Log << Debug << "Starting thread pool with " << optimal_thread_count << " threads";
 
   // Enable thread synchronization
   EnableSync = true;
 
   auto parent_thread_logger = Log;
+  auto session_tag = GetThreadSessionTag();
 
-  for (uint32_t i = 0; i < optimal_thread_count; ++i) {
-    m_threads.emplace_back([this, parent_thread_logger](const std::stop_token& st) {
-      // Use the logger from the parent thread
+  // All deques must exist before any worker starts stealing
+  for (size_t i = 0; i < optimal_thread_count; ++i) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+
+  for (size_t i = 0; i < optimal_thread_count; ++i) {
+    m_threads.emplace_back([this, i, parent_thread_logger, session_tag](const std::stop_token& st) {
+      // Use the logger and session of the parent thread
       Log = parent_thread_logger;
-      ThreadLoop(st);
+      SetThreadSessionTag(session_tag);
+      CURRENT_WORKER = {.m_pool = this, .m_index = i};
+      ThreadLoop(st, i);
     });
   }
 }
 
-void ThreadPool::ThreadLoop(const std::stop_token& st) {
-  Log << Trace << "ThreadPool: ThreadLoop(" << std::this_thread::get_id() << ") started";
+auto ThreadPool::SpinForWork() const -> bool {
+  for (size_t i = 0; i < kSpinIterations; ++i) {
+    if (m_pending.load(std::memory_order_relaxed) != 0) {
+      return true;
+    }
+
+    CpuRelax();
+  }
+
+  return false;
+}
+
+void ThreadPool::WakeOne() {
+  { std::lock_guard lock(m_park_mutex); }
+  m_work_available.notify_one();
+}
 
-  while (!st.stop_requested()) {
-    Task job;
+void ThreadPool::OnTaken() {
+  if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_pending.notify_all();
+  }
+}
+
+auto ThreadPool::TakeFromInjectionQueue(size_t worker_index) -> Task* {
+  std::unique_lock lock(m_injection_mutex);
+  if (m_injection.empty()) {
+    return nullptr;
+  }
 
-    {
-      std::unique_lock lock(m_queue_mutex);
-      if (m_jobs.empty()) {
-        lock.unlock();
+  auto* node = TASK_NODES.Acquire(std::move(m_injection.front()));
+  m_injection.pop_front();
 
-        std::this_thread::sleep_for(std::chrono::microseconds(64));
-        std::this_thread::yield();
-        continue;
+  // Take a fair share of the backlog so the other workers can steal it from us
+  const auto batch = std::min(kMaxInjectionBatch - 1, m_injection.size() / m_workers.size());
+  auto& deque = m_workers[worker_index]->m_deque;
+  for (size_t i = 0; i < batch; ++i) {
+    deque.Push(TASK_NODES.Acquire(std::move(m_injection.front())));
+    m_injection.pop_front();
+  }
+
+  lock.unlock();
+
+  if (batch != 0 && m_parked.load(std::memory_order_seq_cst) != 0) {
+    WakeOne();
+  }
+
+  return node;
+}
+
+auto ThreadPool::StealWork(size_t worker_index) -> Task* {
+  const auto worker_count = m_workers.size();
+  const auto start = NextVictimSeed() % worker_count;
+
+  for (size_t i = 0; i < worker_count; ++i) {
+    const auto victim = (start + i) % worker_count;
+    if (victim == worker_index) {
+      continue;
+    }
+
+    if (auto* node = m_workers[victim]->m_deque.Steal()) {
+      return node;
+    }
+  }
+
+  return nullptr;
+}
+
+auto ThreadPool::FindWork(size_t worker_index) -> Task* {
+  if (auto* node = m_workers[worker_index]->m_deque.Pop()) {
+    return node;
+  }
+
+  if (auto* node = TakeFromInjectionQueue(worker_index)) {
+    return node;
+  }
+
+  return StealWork(worker_index);
+}
+
+void ThreadPool::ThreadLoop(const std::stop_token& st, size_t worker_index) {
+  Log << Trace << "ThreadPool: ThreadLoop(" << std::this_thread::get_id() << ") started";
+
+  while (true) {
+    if (auto* node = FindWork(worker_index)) {
+      OnTaken();
+      (*node)(st);
+      TASK_NODES.Release(node);
+      continue;
+    }
+
+    // Only exit once every scheduled job has been handed out
+    if (st.stop_requested()) {
+      if (m_pending.load(std::memory_order_acquire) == 0) {
+        break;
       }
 
-      job = m_jobs.front();
-      m_jobs.pop();
+      std::this_thread::yield();
+      continue;
+    }
+
+    if (m_pending.load(std::memory_order_relaxed) != 0 || SpinForWork()) {
+      continue;
     }
 
-    job(st);
+    std::unique_lock lock(m_park_mutex);
+    m_parked.fetch_add(1, std::memory_order_seq_cst);
+    m_work_available.wait(lock, st, [this] { return m_pending.load(std::memory_order_seq_cst) != 0; });
+    m_parked.fetch_sub(1, std::memory_order_relaxed);
   }
 
   Log << Trace << "ThreadPool: ThreadLoop(" << std::this_thread::get_id() << ") stopped";
 }
 
 void ThreadPool::Schedule(Task job) {
-  std::lock_guard lock(m_queue_mutex);
-  m_jobs.emplace(std::move(job));
+  // Count the job before publishing it, so the counter never underflows when a worker takes it immediately
+  m_pending.fetch_add(1, std::memory_order_seq_cst);
+
+  if (CURRENT_WORKER.m_pool == this) {
+    m_workers[CURRENT_WORKER.m_index]->m_deque.Push(TASK_NODES.Acquire(std::move(job)));
+  } else {
+    std::lock_guard lock(m_injection_mutex);
+    m_injection.emplace_back(std::move(job));
+  }
+
+  if (m_parked.load(std::memory_order_seq_cst) != 0) {
+    WakeOne();
+  }
 }
 
 void ThreadPool::WaitForAll() {
-  while (!Empty()) {
-    std::this_thread::yield();
+  for (auto pending = m_pending.load(std::memory_order_acquire); pending != 0;
+       pending = m_pending.load(std::memory_order_acquire)) {
+    m_pending.wait(pending, std::memory_order_acquire);
   }
 }
 
-auto ThreadPool::Empty() -> bool {
-  std::lock_guard lock(m_queue_mutex);
-  return m_jobs.empty();
-}
+auto ThreadPool::Empty() -> bool { return m_pending.load(std::memory_order_acquire) == 0; }
 
 void ThreadPool::Stop() {
-  { /* Gracefully request stop */
-    std::lock_guard lock(m_queue_mutex);
-    for (auto& active_thread : m_threads) {
-      active_thread.request_stop();
-    }
-  }
-
-  while (!Empty()) {
+  for (auto& active_thread : m_threads) {
+    active_thread.request_stop();
   }
 
+  // Workers drain the queues before they exit
   m_threads.clear();
 }
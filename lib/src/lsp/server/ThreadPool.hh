@@ -33,27 +33,67 @@
 
 #pragma once
 
-#include <functional>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <lsp/server/Task.hh>
+#include <lsp/server/WorkStealingDeque.hh>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <vector>
 
+/**
+ * Work-stealing thread pool.
+ *
+ * Every worker owns a Chase-Lev deque; tasks scheduled from a worker go onto
+ * its own deque, tasks scheduled from any other thread go through a shared
+ * injection queue. Workers run their own tasks first (LIFO, cache-warm), then
+ * take a batch from the injection queue, then steal (FIFO) from their peers.
+ *
+ * Idle workers spin briefly on an atomic job counter (to absorb bursts
+ * without a syscall), then park on a condition variable. `Schedule()` only
+ * signals when a worker is actually parked, so a busy pool never pays for a
+ * wakeup and an idle pool consumes no CPU.
+ */
 class ThreadPool final {
-  using Task = std::function<void(std::stop_token)>;
+  struct Worker {
+    WorkStealingDeque<Task> m_deque;
+  };
 
-  std::mutex m_queue_mutex;
+  std::vector<std::unique_ptr<Worker>> m_workers;
   std::vector<std::jthread> m_threads;
-  std::queue<std::function<void(std::stop_token)>> m_jobs;
 
-  void ThreadLoop(const std::stop_token &);
+  std::mutex m_injection_mutex;
+  std::deque<Task> m_injection;
+
+  std::mutex m_park_mutex;
+  std::condition_variable_any m_work_available;
+  std::atomic<size_t> m_parked = 0;
+
+  /// Scheduled tasks that no worker has taken yet, across all queues.
+  std::atomic<size_t> m_pending = 0;
+
+  void ThreadLoop(const std::stop_token &, size_t worker_index);
+  auto SpinForWork() const -> bool;
+  auto FindWork(size_t worker_index) -> Task *;
+  auto TakeFromInjectionQueue(size_t worker_index) -> Task *;
+  auto StealWork(size_t worker_index) -> Task *;
+  void OnTaken();
+  void WakeOne();
 
 public:
+  static constexpr size_t kSpinIterations = 4096;
+  static constexpr size_t kMaxInjectionBatch = 32;
+
   ThreadPool() = default;
   ~ThreadPool() { Stop(); }
 
-  void Start();
+  void Start(size_t thread_count = 0);
   void Schedule(Task job);
   void Stop();
   void WaitForAll();
   auto Empty() -> bool;
+
+  [[nodiscard]] auto GetThreadCount() const -> size_t { return m_threads.size(); }
 };
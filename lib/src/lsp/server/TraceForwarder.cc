@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <lsp/protocol/LogTrace.hh>
+#include <lsp/server/TraceForwarder.hh>
+#include <nitrate-core/Logger.hh>
+#include <nlohmann/json.hpp>
+
+using namespace ncc;
+using namespace no3::lsp::core;
+using namespace no3::lsp::message;
+
+/// Set on the forwarder thread so that anything it logs is not fed back into the ring.
+static thread_local bool IN_FORWARDER_THREAD = false;
+
+void TraceForwarder::StripANSI(std::string& str) {
+  static constexpr char kEscape = '\x1B';
+
+  if (str.find(kEscape) == std::string::npos) [[likely]] {
+    return;
+  }
+
+  size_t out = 0;
+  for (size_t i = 0; i < str.size();) {
+    if (str[i] != kEscape) {
+      str[out++] = str[i++];
+      continue;
+    }
+
+    if (i + 1 < str.size() && str[i + 1] == '[') {
+      // CSI: parameter and intermediate bytes, terminated by a final byte in [0x40, 0x7E]
+      size_t j = i + 2;
+      while (j < str.size() && (str[j] < 0x40 || str[j] > 0x7E)) {
+        ++j;
+      }
+
+      i = std::min(j + 1, str.size());
+    } else {
+      // Two-byte escape, or a lone trailing ESC
+      i = std::min(i + 2, str.size());
+    }
+  }
+
+  str.resize(out);
+}
+
+TraceForwarder::TraceForwarder(MessageWriter& writer) : m_writer(writer), m_ring(kRingCapacity) {
+  m_thread = std::jthread([this](const std::stop_token& st) {
+    IN_FORWARDER_THREAD = true;
+    ForwarderLoop(st);
+  });
+}
+
+TraceForwarder::~TraceForwarder() {
+  m_thread.request_stop();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void TraceForwarder::Submit(std::string line) {
+  if (IN_FORWARDER_THREAD) [[unlikely]] {
+    return;
+  }
+
+  StripANSI(line);
+
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_ring_size == m_ring.size()) [[unlikely]] {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    m_ring[(m_ring_head + m_ring_size) % m_ring.size()] = std::move(line);
+    ++m_ring_size;
+  }
+
+  m_not_empty.notify_one();
+}
+
+void TraceForwarder::SendBatch(std::vector<std::string>& lines) {
+  const auto dropped = m_dropped.load(std::memory_order_relaxed);
+
+  std::string message;
+  if (dropped != m_dropped_reported) [[unlikely]] {
+    message = "[no3] " + std::to_string(dropped - m_dropped_reported) + " trace message(s) dropped";
+    m_dropped_reported = dropped;
+  }
+
+  for (auto& line : lines) {
+    if (!message.empty()) {
+      message.push_back('\n');
+    }
+
+    message += line;
+  }
+
+  m_forwarded.fetch_add(lines.size(), std::memory_order_relaxed);
+  lines.clear();
+
+  auto notification = LogTraceNotification(std::move(message));
+  m_writer.Enqueue(nlohmann::to_string(*notification.Finalize()));
+}
+
+void TraceForwarder::ForwarderLoop(const std::stop_token& st) {
+  std::vector<std::string> batch;
+  batch.reserve(kMaxBatchLines);
+
+  auto next_batch_time = std::chrono::steady_clock::now();
+
+  while (true) {
+    size_t batch_bytes = 0;
+
+    {
+      std::unique_lock lock(m_mutex);
+      m_not_empty.wait(lock, st, [&] { return m_ring_size != 0; });
+
+      const auto stopping = st.stop_requested();
+      if (stopping && m_ring_size == 0) {
+        break;
+      }
+
+      // Pace notifications; lines keep accumulating in the ring meanwhile
+      if (!stopping && std::chrono::steady_clock::now() < next_batch_time) {
+        m_not_empty.wait_until(lock, st, next_batch_time, [] { return false; });
+        continue;
+      }
+
+      while (m_ring_size != 0 && batch.size() < kMaxBatchLines && batch_bytes < kMaxBatchBytes) {
+        auto& line = m_ring[m_ring_head];
+        batch_bytes += line.size() + 1;
+        batch.push_back(std::move(line));
+
+        m_ring_head = (m_ring_head + 1) % m_ring.size();
+        --m_ring_size;
+      }
+    }
+
+    SendBatch(batch);
+    next_batch_time = std::chrono::steady_clock::now() + kMinBatchInterval;
+  }
+
+  if (m_dropped.load(std::memory_order_relaxed) != m_dropped_reported) {
+    SendBatch(batch);
+  }
+}
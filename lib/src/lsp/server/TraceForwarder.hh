@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <lsp/server/MessageWriter.hh>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace no3::lsp::core {
+  /**
+   * @brief Asynchronous `$/logTrace` pipeline.
+   *
+   * Logging threads only strip ANSI escapes and append to a bounded ring; they
+   * never serialize JSON or touch the transport. A background thread drains the
+   * ring, coalesces lines into a single notification, and paces notifications
+   * so that verbose tracing cannot saturate the connection. Lines that arrive
+   * while the ring is full are dropped and reported in the next batch.
+   */
+  class TraceForwarder final {
+    MessageWriter& m_writer;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_not_empty;
+    std::vector<std::string> m_ring;
+    size_t m_ring_head = 0;
+    size_t m_ring_size = 0;
+
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<uint64_t> m_forwarded = 0;
+    uint64_t m_dropped_reported = 0;
+
+    std::jthread m_thread;
+
+    void ForwarderLoop(const std::stop_token& st);
+    void SendBatch(std::vector<std::string>& lines);
+
+  public:
+    static constexpr size_t kRingCapacity = 4096;
+    static constexpr size_t kMaxBatchLines = 256;
+    static constexpr size_t kMaxBatchBytes = 64 * 1024;
+    static constexpr auto kMinBatchInterval = std::chrono::milliseconds(20);
+
+    TraceForwarder(MessageWriter& writer);
+    TraceForwarder(const TraceForwarder&) = delete;
+    TraceForwarder(TraceForwarder&&) = delete;
+    ~TraceForwarder();
+
+    /// Never blocks on I/O; may be called from any thread.
+    void Submit(std::string line);
+
+    [[nodiscard]] auto GetDroppedCount() const -> uint64_t { return m_dropped.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto GetForwardedCount() const -> uint64_t { return m_forwarded.load(std::memory_order_relaxed); }
+
+    /// Remove ANSI escape sequences in place.
+    static void StripANSI(std::string& str);
+  };
+}  // namespace no3::lsp::core
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+///                                                                          ///
+///     .-----------------.    .----------------.     .----------------.     ///
+///    | .--------------. |   | .--------------. |   | .--------------. |    ///
+///    | | ____  _____  | |   | |     ____     | |   | |    ______    | |    ///
+///    | ||_   _|_   _| | |   | |   .'    `.   | |   | |   / ____ `.  | |    ///
+///    | |  |   \ | |   | |   | |  /  .--.  \  | |   | |   `'  __) |  | |    ///
+///    | |  | |\ \| |   | |   | |  | |    | |  | |   | |   _  |__ '.  | |    ///
+///    | | _| |_\   |_  | |   | |  \  `--'  /  | |   | |  | \____) |  | |    ///
+///    | ||_____|\____| | |   | |   `.____.'   | |   | |   \______.'  | |    ///
+///    | |              | |   | |              | |   | |              | |    ///
+///    | '--------------' |   | '--------------' |   | '--------------' |    ///
+///     '----------------'     '----------------'     '----------------'     ///
+///                                                                          ///
+///   * NITRATE TOOLCHAIN - The official toolchain for the Nitrate language. ///
+///   * Copyright (C) 2024 Wesley C. Jones                                   ///
+///                                                                          ///
+///   The Nitrate Toolchain is free software; you can redistribute it or     ///
+///   modify it under the terms of the GNU Lesser General Public             ///
+///   License as published by the Free Software Foundation; either           ///
+///   version 2.1 of the License, or (at your option) any later version.     ///
+///                                                                          ///
+///   The Nitrate Toolcain is distributed in the hope that it will be        ///
+///   useful, but WITHOUT ANY WARRANTY; without even the implied warranty of ///
+///   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU      ///
+///   Lesser General Public License for more details.                        ///
+///                                                                          ///
+///   You should have received a copy of the GNU Lesser General Public       ///
+///   License along with the Nitrate Toolchain; if not, see                  ///
+///   <https://www.gnu.org/licenses/>.                                       ///
+///                                                                          ///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Chase-Lev work-stealing deque of `T*` (Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models", PPoPP 2013).
+ *
+ * The owning thread pushes and pops at the bottom without contention; any
+ * other thread may steal from the top. The ring grows on demand; retired
+ * rings are kept until destruction because a thief may still be reading one.
+ */
+template <typename T>
+class WorkStealingDeque final {
+  struct Ring {
+    int64_t m_mask;
+    std::unique_ptr<std::atomic<T*>[]> m_slots;
+
+    Ring(int64_t capacity) : m_mask(capacity - 1), m_slots(std::make_unique<std::atomic<T*>[]>(capacity)) {}
+
+    [[nodiscard]] auto Capacity() const -> int64_t { return m_mask + 1; }
+    [[nodiscard]] auto Get(int64_t i) const -> T* { return m_slots[i & m_mask].load(std::memory_order_relaxed); }
+    void Put(int64_t i, T* item) { m_slots[i & m_mask].store(item, std::memory_order_relaxed); }
+  };
+
+  alignas(64) std::atomic<int64_t> m_top = 0;
+  alignas(64) std::atomic<int64_t> m_bottom = 0;
+  std::atomic<Ring*> m_ring;
+  std::vector<std::unique_ptr<Ring>> m_rings;
+
+  auto Grow(Ring* ring, int64_t bottom, int64_t top) -> Ring* {
+    auto grown = std::make_unique<Ring>(ring->Capacity() * 2);
+    for (auto i = top; i < bottom; ++i) {
+      grown->Put(i, ring->Get(i));
+    }
+
+    auto* result = grown.get();
+    m_rings.push_back(std::move(grown));
+    m_ring.store(result, std::memory_order_release);
+
+    return result;
+  }
+
+public:
+  static constexpr int64_t kInitialCapacity = 256;
+
+  WorkStealingDeque() {
+    m_rings.push_back(std::make_unique<Ring>(kInitialCapacity));
+    m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque(WorkStealingDeque&&) = delete;
+
+  /// Owner only.
+  void Push(T* item) {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed);
+    const auto top = m_top.load(std::memory_order_acquire);
+    auto* ring = m_ring.load(std::memory_order_relaxed);
+
+    if (bottom - top > ring->Capacity() - 1) [[unlikely]] {
+      ring = Grow(ring, bottom, top);
+    }
+
+    ring->Put(bottom, item);
+    m_bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  /// Owner only. Returns `nullptr` when empty.
+  auto Pop() -> T* {
+    const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    auto* ring = m_ring.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    auto* item = ring->Get(bottom);
+    if (top == bottom) {
+      // Last item; race against thieves for it
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return item;
+  }
+
+  /// Any thread. Returns `nullptr` when empty or when another thread won the race.
+  auto Steal() -> T* {
+    auto top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    auto* item = m_ring.load(std::memory_order_acquire)->Get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+
+    return item;
+  }
+
+  [[nodiscard]] auto SizeHint() const -> int64_t {
+    return std::max<int64_t>(m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed), 0);
+  }
+};
@@ -31,6 +31,7 @@
 ///                                                                          ///
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <lsp/server/Context.hh>
 #include <nitrate-core/Logger.hh>
 
@@ -44,9 +45,141 @@ static auto VerifyInitializeRequest(const nlohmann::json& j) -> bool {
     }
   }
 
+  if (j.contains("capabilities") && j["capabilities"].is_object()) {
+    const auto& capabilities = j["capabilities"];
+
+    if (capabilities.contains("general") && capabilities["general"].is_object()) {
+      const auto& general = capabilities["general"];
+
+      if (general.contains("positionEncodings") && !general["positionEncodings"].is_array()) {
+        return false;
+      }
+    }
+  }
+
+  if (j.contains("initializationOptions") && j["initializationOptions"].is_object()) {
+    const auto& options = j["initializationOptions"];
+
+    if (options.contains("contentEncodings") && !options["contentEncodings"].is_array()) {
+      return false;
+    }
+
+    if (options.contains("contentEncodingThreshold") && !options["contentEncodingThreshold"].is_number_unsigned()) {
+      return false;
+    }
+
+    if (options.contains("analysisDebounceMs") && !options["analysisDebounceMs"].is_number_unsigned()) {
+      return false;
+    }
+
+    if (options.contains("analysisMaxLatencyMs") && !options["analysisMaxLatencyMs"].is_number_unsigned()) {
+      return false;
+    }
+
+    if (options.contains("queueLimits")) {
+      const auto& limits = options["queueLimits"];
+      if (!limits.is_object()) {
+        return false;
+      }
+
+      for (const auto* key : {"interactive", "visibleRange", "background"}) {
+        if (limits.contains(key) && !limits[key].is_number_unsigned()) {
+          return false;
+        }
+      }
+    }
+  }
+
   return true;
 }
 
+static auto NegotiateDeflate(const nlohmann::json& j) -> std::optional<size_t> {
+  static constexpr size_t kDefaultDeflateThreshold = 4096;
+
+  if (!j.contains("initializationOptions") || !j["initializationOptions"].is_object()) {
+    return std::nullopt;
+  }
+
+  const auto& options = j["initializationOptions"];
+  if (!options.contains("contentEncodings")) {
+    return std::nullopt;
+  }
+
+  const auto& encodings = options["contentEncodings"];
+  const auto supported = std::ranges::any_of(encodings, [](const auto& encoding) {
+    return encoding.is_string() && encoding.template get<std::string_view>() == core::kDeflateContentEncoding;
+  });
+
+  if (!supported) {
+    return std::nullopt;
+  }
+
+  if (options.contains("contentEncodingThreshold")) {
+    return options["contentEncodingThreshold"].get<size_t>();
+  }
+
+  return kDefaultDeflateThreshold;
+}
+
+/// UTF-8 is preferred: columns are then byte offsets and need no decoding. UTF-16 is the mandatory fallback.
+static auto NegotiatePositionEncoding(const nlohmann::json& j) -> protocol::PositionEncoding {
+  if (!j.contains("capabilities") || !j["capabilities"].is_object()) {
+    return protocol::PositionEncoding::UTF16;
+  }
+
+  const auto& capabilities = j["capabilities"];
+  if (!capabilities.contains("general") || !capabilities["general"].is_object() ||
+      !capabilities["general"].contains("positionEncodings")) {
+    return protocol::PositionEncoding::UTF16;
+  }
+
+  const auto& encodings = capabilities["general"]["positionEncodings"];
+  const auto supports_utf8 = std::ranges::any_of(encodings, [](const auto& encoding) {
+    return encoding.is_string() && encoding.template get<std::string_view>() == "utf-8";
+  });
+
+  return supports_utf8 ? protocol::PositionEncoding::UTF8 : protocol::PositionEncoding::UTF16;
+}
+
+static void ConfigureAnalysisDebounce(const nlohmann::json& j, core::Debouncer& debouncer) {
+  if (!j.contains("initializationOptions") || !j["initializationOptions"].is_object()) {
+    return;
+  }
+
+  // Large values would overflow the debouncer's time_point arithmetic
+  static constexpr uint64_t kMaxDelayMs = 60 * 1000;
+
+  const auto& options = j["initializationOptions"];
+  auto quiet_period = std::chrono::milliseconds(core::Debouncer::kDefaultQuietPeriod);
+  auto max_latency = std::chrono::milliseconds(core::Debouncer::kDefaultMaxLatency);
+
+  if (options.contains("analysisDebounceMs")) {
+    quiet_period = std::chrono::milliseconds(std::min(options["analysisDebounceMs"].get<uint64_t>(), kMaxDelayMs));
+  }
+
+  if (options.contains("analysisMaxLatencyMs")) {
+    max_latency = std::chrono::milliseconds(std::min(options["analysisMaxLatencyMs"].get<uint64_t>(), kMaxDelayMs));
+  }
+
+  debouncer.SetTimings(quiet_period, max_latency);
+}
+
+static void ConfigureQueueLimits(const nlohmann::json& j, core::QueueLimits& limits) {
+  if (!j.contains("initializationOptions") || !j["initializationOptions"].is_object()) {
+    return;
+  }
+
+  const auto& options = j["initializationOptions"];
+  if (!options.contains("queueLimits")) {
+    return;
+  }
+
+  const auto& config = options["queueLimits"];
+  limits.m_interactive = config.value("interactive", limits.m_interactive);
+  limits.m_visible_range = config.value("visibleRange", limits.m_visible_range);
+  limits.m_background = config.value("background", limits.m_background);
+}
+
 void core::Context::RequestInitialize(const message::RequestMessage& request, message::ResponseMessage& response) {
   const auto& req = *request;
   if (!VerifyInitializeRequest(req)) [[unlikely]] {
@@ -65,13 +198,19 @@ void core::Context::RequestInitialize(const message::RequestMessage& request, me
     }
   }
 
+  m_deflate_threshold = NegotiateDeflate(req);
+  m_fs.SetPositionEncoding(NegotiatePositionEncoding(req));
+  ConfigureAnalysisDebounce(req, m_analysis_debouncer);
+  ConfigureQueueLimits(req, m_queue_limits);
+
   ////==========================================================================
   auto& j = *response;
 
   j["serverInfo"]["name"] = "nitrateLanguageServer";
   j["serverInfo"]["version"] = "0.0.1";
 
-  j["capabilities"]["positionEncoding"] = "utf-16";
+  j["capabilities"]["positionEncoding"] =
+      m_fs.GetPositionEncoding() == protocol::PositionEncoding::UTF8 ? "utf-8" : "utf-16";
   j["capabilities"]["textDocumentSync"] = {
       {"openClose", true},
       {"change", protocol::TextDocumentSyncKind::Incremental},
@@ -81,6 +220,10 @@ void core::Context::RequestInitialize(const message::RequestMessage& request, me
       {"triggerCharacters", {".", "::"}},
   };
 
+  if (m_deflate_threshold.has_value()) {
+    j["capabilities"]["experimental"]["contentEncoding"] = core::kDeflateContentEncoding;
+  }
+
   ////==========================================================================
   Log << Debug << "Context::RequestInitialize(): LSP initialize requested";
   m_is_lsp_initialized = true;
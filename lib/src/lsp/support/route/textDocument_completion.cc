@@ -86,12 +86,17 @@ void core::Context::RequestCompletion(const message::RequestMessage& request, me
     return;
   }
 
-  auto offset = file->GetOffset(line, character);
+  auto offset = file->GetOffset(line, character, m_fs.GetPositionEncoding());
   if (!offset) {
     Log << "Invalid position: " << line << ":" << character;
     return;
   }
 
+  // The client has moved on (e.g. the user kept typing); don't spend the pool on a stale position
+  if (request.IsCancelled()) {
+    return;
+  }
+
   // auto rd = file->ReadAll();
   // rd->seekg(*offset);
 
@@ -34,133 +34,151 @@
 #include <lsp/protocol/Base.hh>
 #include <lsp/resource/FileBrowser.hh>
 #include <lsp/server/Context.hh>
+#include <lsp/server/JsonScanner.hh>
 #include <nitrate-core/Assert.hh>
 #include <nitrate-core/Logger.hh>
 #include <utility>
 
-#ifndef NDEBUG
-#include <fstream>
-#endif
-
 using namespace ncc;
 using namespace no3::lsp;
 using namespace no3::lsp::protocol;
 
-static auto VerifyTextDocumentDidChange(const nlohmann::json& j) -> bool {
-  if (!j.is_object()) {
-    return false;
-  }
+namespace {
+  struct DidChangeParams {
+    std::optional<std::string> m_uri;
+    std::optional<int64_t> m_version;
+    std::vector<TextDocumentContentChangeEvent> m_content_changes;
+    bool m_has_content_changes = false;
+  };
+}  // namespace
+
+static auto ReadPosition(core::JsonScanner& value, Position& position) -> bool {
+  std::optional<int64_t> line;
+  std::optional<int64_t> character;
+
+  const auto ok = value.ReadObject([&](std::string_view key, core::JsonScanner& value) {
+    if (key == "line") {
+      return value.ReadInteger(line.emplace());
+    }
 
-  if (!j.contains("textDocument") || !j["textDocument"].is_object()) {
-    return false;
-  }
+    if (key == "character") {
+      return value.ReadInteger(character.emplace());
+    }
 
-  const auto& text_document = j["textDocument"];
+    return value.SkipValue();
+  });
 
-  if (!text_document.contains("uri") || !text_document["uri"].is_string()) {
+  if (!ok || !line.has_value() || !character.has_value()) {
     return false;
   }
 
-  if (!text_document.contains("version") || !text_document["version"].is_number_integer()) {
-    return false;
-  }
+  position = Position(*line, *character);
 
-  if (!j.contains("contentChanges") || !j["contentChanges"].is_array()) {
-    return false;
-  }
+  return true;
+}
+
+static auto ReadRange(core::JsonScanner& value, Range& range) -> bool {
+  bool has_start = false;
+  bool has_end = false;
+
+  const auto ok = value.ReadObject([&](std::string_view key, core::JsonScanner& value) {
+    if (key == "start") {
+      return has_start = ReadPosition(value, range.m_start);
+    }
+
+    if (key == "end") {
+      return has_end = ReadPosition(value, range.m_end);
+    }
+
+    return value.SkipValue();
+  });
+
+  return ok && has_start && has_end;
+}
 
-  return std::all_of(j["contentChanges"].begin(), j["contentChanges"].end(), [](const auto& content_change) {
-    if (!content_change.is_object()) {
-      return false;
+static auto ReadContentChange(core::JsonScanner& value, TextDocumentContentChangeEvent& change) -> bool {
+  bool has_text = false;
+
+  const auto ok = value.ReadObject([&](std::string_view key, core::JsonScanner& value) {
+    if (key == "text") {
+      // Decoded exactly once, straight into the buffer handed to the file browser
+      return has_text = value.ReadString(change.m_text);
     }
 
-    // Both variants require the text field
-    if (!content_change.contains("text") || !content_change["text"].is_string()) {
-      return false;
+    if (key == "range") {
+      return ReadRange(value, change.m_range.emplace());
     }
 
-    // Only incremental sync requires the range field
-    if (content_change.contains("range")) {
-      if (!content_change["range"].is_object()) {
-        return false;
-      }
-
-      const auto& range = content_change["range"];
-      if (!range.contains("start") || !range["start"].is_object()) {
-        return false;
-      }
-      if (!range.contains("end") || !range["end"].is_object()) {
-        return false;
-      }
-
-      const auto& start = range["start"];
-      if (!start.contains("line") || !start["line"].is_number_integer() || !start.contains("character") ||
-          !start["character"].is_number_integer()) {
-        return false;
-      }
-
-      const auto& end = range["end"];
-      if (!end.contains("line") || !end["line"].is_number_integer() || !end.contains("character") ||
-          !end["character"].is_number_integer()) {
-        return false;
-      }
+    return value.SkipValue();
+  });
+
+  // Both variants require the text field; only incremental sync has a range
+  return ok && has_text;
+}
+
+static auto ReadTextDocumentDidChange(std::string_view raw) -> std::optional<DidChangeParams> {
+  DidChangeParams params;
+  core::JsonScanner scanner(raw);
+
+  const auto ok = scanner.ReadObject([&](std::string_view key, core::JsonScanner& value) {
+    if (key == "textDocument") {
+      return value.ReadObject([&](std::string_view key, core::JsonScanner& value) {
+        if (key == "uri") {
+          return value.ReadString(params.m_uri.emplace());
+        }
+
+        if (key == "version") {
+          return value.ReadInteger(params.m_version.emplace());
+        }
+
+        return value.SkipValue();
+      });
+    }
+
+    if (key == "contentChanges") {
+      params.m_has_content_changes = true;
+
+      return value.ReadArray([&](core::JsonScanner& value) {
+        return ReadContentChange(value, params.m_content_changes.emplace_back());
+      });
     }
 
-    return true;
+    return value.SkipValue();
   });
+
+  if (!ok || !scanner.AtEnd() || !params.m_uri.has_value() || !params.m_version.has_value() ||
+      !params.m_has_content_changes) {
+    return std::nullopt;
+  }
+
+  return params;
 }
 
 void core::Context::NotifyTextDocumentDidChange(const message::NotifyMessage& notice) {
-  const auto& j = *notice;
+  std::string materialized;
+  auto raw = notice.GetRawJson();
+  if (raw.empty()) [[unlikely]] {
+    materialized = (*notice).dump();
+    raw = materialized;
+  }
 
-  auto sync_kind = VerifyTextDocumentDidChange(j);
-  if (!sync_kind) {
+  auto params = ReadTextDocumentDidChange(raw);
+  if (!params.has_value()) {
     Log << "Invalid textDocument/didChange notification";
     return;
   }
 
-  const auto& file_uri = FlyString(j["textDocument"]["uri"].get<std::string>());
-  const auto& version = j["textDocument"]["version"].get<int64_t>();
-  const auto& content_changes = j["contentChanges"];
-
-  for (const auto& content_change : content_changes) {
-    if (const auto is_incremental_change = content_change.contains("range")) {
-      const auto start_line = content_change["range"]["start"]["line"].get<int64_t>();
-      const auto start_character = content_change["range"]["start"]["character"].get<int64_t>();
-      const auto end_line = content_change["range"]["end"]["line"].get<int64_t>();
-      const auto end_character = content_change["range"]["end"]["character"].get<int64_t>();
-      const auto& new_content = content_change["text"].get<std::string>();
-
-      TextDocumentContentChangeEvent change;
-      change.m_range = Range(Position(start_line, start_character), Position(end_line, end_character));
-      change.m_text = FlyByteString(new_content.begin(), new_content.end());
-
-      const std::array changes = {std::move(change)};
-      if (!m_fs.DidChanges(file_uri, version, changes)) {
-        Log << "Failed to apply changes to text document: " << file_uri;
-        return;
-      }
-    } else {
-      const auto& new_content = content_change["text"].get<std::string>();
-      if (!m_fs.DidChange(file_uri, version, FlyByteString(new_content.begin(), new_content.end()))) {
-        Log << "Failed to apply changes to text document: " << file_uri;
-        return;
-      }
-    }
+  const auto file_uri = FlyString(std::move(*params->m_uri));
+  const auto version = *params->m_version;
+
+  // One snapshot per notification, however many ranges a multi-cursor edit or format-on-type sends
+  if (!m_fs.DidChanges(file_uri, version, params->m_content_changes)) {
+    Log << "Failed to apply changes to text document: " << file_uri;
+    return;
   }
 
   Log << Debug << "Applied changes to text document: " << file_uri;
 
-#ifndef NDEBUG
-  {
-    auto raw_content = *m_fs.GetFile(file_uri).value()->ReadAll();
-
-    auto debug_output = std::fstream("/tmp/nitrate_lsp_debug.txt", std::ios::out | std::ios::trunc | std::ios::binary);
-    if (!debug_output) {
-      qcore_panic("Failed to open debug output file");
-    }
-
-    debug_output.write(reinterpret_cast<const char*>(raw_content.c_str()), raw_content.size());
-  }
-#endif
+  // Reparse, diagnostics and indexing run once the burst has settled
+  m_analysis_debouncer.Touch(file_uri.get(), version);
 }
@@ -58,6 +58,8 @@ void core::Context::NotifyTextDocumentDidClose(const message::NotifyMessage& not
 
   const auto& uri = j["textDocument"]["uri"].get<std::string>();
 
+  m_analysis_debouncer.Cancel(uri);
+
   if (!m_fs.DidClose(FlyString(uri))) {
     Log << "Failed to close text document: " << uri;
     return;
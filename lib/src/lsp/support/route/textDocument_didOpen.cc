@@ -78,4 +78,6 @@ void core::Context::NotifyTextDocumentDidOpen(const message::NotifyMessage& noti
   }
 
   Log << Debug << "Opened text document: " << uri;
+
+  m_analysis_debouncer.Touch(uri, version);
 }
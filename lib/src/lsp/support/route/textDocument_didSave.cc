@@ -79,6 +79,9 @@ void core::Context::NotifyTextDocumentDidSave(const message::NotifyMessage& noti
 
   Log << Debug << "Saved text document: " << file_uri;
 
+  // The user asked for a checkpoint; don't make them wait out the quiet period
+  m_analysis_debouncer.Flush(file_uri.get());
+
 #ifndef NDEBUG
   {
     auto raw_content = *m_fs.GetFile(file_uri).value()->ReadAll();